@@ -0,0 +1,508 @@
+#include "BlockchainCore.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Comptabilité des allocations (voir AllocSample) : compteurs propres à chaque thread, sans atomique.
+// Le remplacement de l'opérateur new ne vaut que pour les builds de profilage (-DATELIER_ALLOC_STATS).
+#ifdef ATELIER_ALLOC_STATS
+namespace { thread_local uint64_t allocCount = 0, allocBytes = 0; }
+
+void* operator new(size_t n) {
+    ++allocCount; allocBytes += n;
+    for (;;) {
+        if (void* p = malloc(n ? n : 1)) return p;
+        new_handler handler = get_new_handler();
+        if (!handler) throw bad_alloc();
+        handler();
+    }
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+bool allocStatsAvailable() { return true; }
+AllocSample threadAllocations() { return {allocCount, allocBytes}; }
+#else
+bool allocStatsAvailable() { return false; }
+AllocSample threadAllocations() { return {}; }
+#endif
+
+Arena& threadArena() { thread_local Arena arena; return arena; }
+
+HashWords fastHashWords(const char* data, size_t n) {
+    const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t h1 = FNV_OFFSET;
+    uint64_t h2 = FNV_OFFSET ^ 0xCAFEBABEDEADBEEFULL;
+
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = (unsigned char)data[i];
+        h1 ^= c;
+        h1 *= FNV_PRIME;
+        h1 ^= (h1 >> 12);
+
+        h2 ^= (uint64_t)c + 0x9e3779b97f4a7c15ULL + (h2 << 6) + (h2 >> 2);
+    }
+
+    return {{h1 ^ (h2 >> 7), h2 ^ (h1 << 3), ~h1, ~h2}};
+}
+
+void writeHex(const HashWords& h, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (int k = 0; k < 4; ++k)
+        for (int j = 0; j < 16; ++j) out[16 * k + j] = digits[(h.w[k] >> (60 - 4 * j)) & 15];
+}
+
+bool parseHex(const string& hex, HashWords& out) {
+    if (hex.size() != 64) return false;
+    for (int k = 0; k < 4; ++k) {
+        uint64_t w = 0;
+        for (int j = 0; j < 16; ++j) {
+            char c = hex[16 * k + j];
+            unsigned d = c >= '0' && c <= '9' ? unsigned(c - '0') : c >= 'a' && c <= 'f' ? unsigned(c - 'a' + 10) : 16;
+            if (d == 16) return false;
+            w = (w << 4) | d;
+        }
+        out.w[k] = w;
+    }
+    return true;
+}
+
+string fastSHA256(const string& data) {
+    char buf[64];
+    writeHex(fastHashWords(data), buf);
+    return string(buf, 64);
+}
+
+// input(i) donne le i-ième message sous forme de string_view
+template<class Input>
+static void hashBatch(Input input, size_t n, HashWords* out) {
+    const size_t LANES = 4;
+    const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    for (size_t base = 0; base < n; base += LANES) {
+        size_t lanes = min(LANES, n - base);
+        uint64_t h1[LANES], h2[LANES];
+        const unsigned char* p[LANES];
+        size_t common = SIZE_MAX;
+        for (size_t l = 0; l < LANES; ++l) {
+            string_view in = input(base + (l < lanes ? l : 0));
+            p[l] = (const unsigned char*)in.data();
+            common = min(common, in.size());
+            h1[l] = FNV_OFFSET;
+            h2[l] = FNV_OFFSET ^ 0xCAFEBABEDEADBEEFULL;
+        }
+        for (size_t i = 0; i < common; ++i) {
+#pragma GCC unroll 4
+            for (size_t l = 0; l < LANES; ++l) {
+                uint64_t c = p[l][i];
+                h1[l] ^= c;
+                h1[l] *= FNV_PRIME;
+                h1[l] ^= (h1[l] >> 12);
+                h2[l] ^= c + 0x9e3779b97f4a7c15ULL + (h2[l] << 6) + (h2[l] >> 2);
+            }
+        }
+        for (size_t l = 0; l < lanes; ++l) {
+            size_t len = input(base + l).size();
+            for (size_t i = common; i < len; ++i) {
+                uint64_t c = p[l][i];
+                h1[l] ^= c;
+                h1[l] *= FNV_PRIME;
+                h1[l] ^= (h1[l] >> 12);
+                h2[l] ^= c + 0x9e3779b97f4a7c15ULL + (h2[l] << 6) + (h2[l] >> 2);
+            }
+            out[base + l] = {{h1[l] ^ (h2[l] >> 7), h2[l] ^ (h1[l] << 3), ~h1[l], ~h2[l]}};
+        }
+    }
+}
+
+void fastHashBatch(const string* const* inputs, size_t n, HashWords* out) {
+    hashBatch([&](size_t i) { return string_view(*inputs[i]); }, n, out);
+}
+
+void fastHashBatch(const string_view* inputs, size_t n, HashWords* out) {
+    hashBatch([&](size_t i) { return inputs[i]; }, n, out);
+}
+
+// Parents hachés par groupes (fastHashBatch)
+static const size_t MERKLE_GROUP = 64;
+
+// Réduit sur place un niveau de n hashes hexadécimaux contigus (64 caractères chacun) jusqu'à la
+// racine, écrite au début de level. Les deux enfants d'un parent sont adjacents : leur
+// concaténation est hachée sans copie ; le parent p est écrit à la place 64*p, déjà lue.
+static void reduceMerkleLevel(char* level, size_t n) {
+    string_view in[MERKLE_GROUP];
+    HashWords out[MERKLE_GROUP];
+    char odd[128];
+    while (n > 1) {
+        size_t parents = (n + 1) / 2;
+        for (size_t g = 0; g < parents; g += MERKLE_GROUP) {
+            size_t m = min(MERKLE_GROUP, parents - g);
+            for (size_t i = 0; i < m; ++i) {
+                const char* left = level + 128 * (g + i);
+                if (2 * (g + i) + 1 < n) in[i] = string_view(left, 128);
+                else { memcpy(odd, left, 64); memcpy(odd + 64, left, 64); in[i] = string_view(odd, 128); } // dernier dupliqué
+            }
+            fastHashBatch(in, m, out);
+            for (size_t i = 0; i < m; ++i) writeHex(out[i], level + 64 * (g + i));
+        }
+        n = parents;
+    }
+}
+
+string calculateMerkleRoot(const vector<string>& txs) {
+    TraceSpan span("arbre Merkle", "merkle", (int64_t)txs.size());
+    if (txs.empty()) return string(64,'0');
+    if (txs.size() == 1) return txs[0];
+    // Premier niveau : feuilles de longueur quelconque, concaténées par paires dans l'arène
+    ArenaScope scratch;
+    size_t n = txs.size(), parents = (n + 1) / 2;
+    char* level = scratch.alloc<char>(64 * parents);
+    string_view in[MERKLE_GROUP];
+    HashWords out[MERKLE_GROUP];
+    for (size_t g = 0; g < parents; g += MERKLE_GROUP) {
+        ArenaScope pairs;
+        size_t m = min(MERKLE_GROUP, parents - g);
+        for (size_t i = 0; i < m; ++i) {
+            const string& left = txs[2 * (g + i)];
+            const string& right = 2 * (g + i) + 1 < n ? txs[2 * (g + i) + 1] : left;
+            char* p = pairs.alloc<char>(left.size() + right.size());
+            memcpy(p, left.data(), left.size());
+            memcpy(p + left.size(), right.data(), right.size());
+            in[i] = string_view(p, left.size() + right.size());
+        }
+        fastHashBatch(in, m, out);
+        for (size_t i = 0; i < m; ++i) writeHex(out[i], level + 64 * (g + i));
+    }
+    reduceMerkleLevel(level, parents);
+    return string(level, 64);
+}
+
+AccountTable& accounts() { static AccountTable table; return table; }
+
+char* formatAmount(char* first, char* last, Amount a) {
+    uint64_t u = a < 0 ? 0 - (uint64_t)a : (uint64_t)a;
+    if (a < 0) *first++ = '-';
+    first = to_chars(first, last, u / AMOUNT_SCALE).ptr;
+    uint64_t frac = u % AMOUNT_SCALE;
+    if (frac) {
+        char digits[8];
+        for (int i = 7; i >= 0; --i) { digits[i] = char('0' + frac % 10); frac /= 10; }
+        int n = 8;
+        while (digits[n-1] == '0') --n;
+        *first++ = '.';
+        memcpy(first, digits, n);
+        first += n;
+    }
+    return first;
+}
+
+string formatAmount(Amount a) { char buf[64]; return string(buf, formatAmount(buf, buf + sizeof(buf), a)); }
+
+bool getStr(const string& in, size_t& p, string& str) {
+    if(in.size()-p<4) return false;
+    size_t len=getLE(in.data()+p,4); p+=4;
+    if(in.size()-p<len) return false;
+    str.assign(in,p,len); p+=len; return true;
+}
+
+void encodeTx(int id, const string& sender, const string& receiver, Amount amount, string& out) {
+    putLE(out,(uint32_t)id,4);
+    putStr(out,sender);
+    putStr(out,receiver);
+    putLE(out,(uint64_t)amount,8);
+}
+
+char* encodeTx(int id, const string& sender, const string& receiver, Amount amount, char* out) {
+    auto le = [&](uint64_t v, int bytes) { for (int i = 0; i < bytes; ++i) *out++ = (char)(v >> (8 * i)); };
+    le((uint32_t)id, 4);
+    le(sender.size(), 4); memcpy(out, sender.data(), sender.size()); out += sender.size();
+    le(receiver.size(), 4); memcpy(out, receiver.data(), receiver.size()); out += receiver.size();
+    le((uint64_t)amount, 8);
+    return out;
+}
+
+void encodeTx(const Transaction& tx, string& out) { encodeTx(tx.id,accounts().name(tx.sender),accounts().name(tx.receiver),tx.amount,out); }
+
+string encodeTx(const Transaction& tx) { string out; encodeTx(tx,out); return out; }
+
+size_t encodedTxSize(const Transaction& tx) { return 20+accounts().name(tx.sender).size()+accounts().name(tx.receiver).size(); }
+
+bool decodeTx(const string& in, size_t& pos, Transaction& tx) {
+    size_t p=pos;
+    if(p>in.size() || in.size()-p<4) return false;
+    int id=(int32_t)getLE(in.data()+p,4); p+=4;
+    string s,r;
+    if(!getStr(in,p,s) || !getStr(in,p,r) || in.size()-p<8) return false;
+    Amount a=(Amount)getLE(in.data()+p,8); p+=8;
+    tx=Transaction(id,accounts().intern(s),accounts().intern(r),a);
+    pos=p;
+    return true;
+}
+
+// Feuilles encodées et hachées par groupes dans l'arène, puis niveaux réduits sur place :
+// la seule allocation est la chaîne de la racine renvoyée
+string computeTxMerkleRoot(const TxColumns& txs) {
+    size_t n = txs.size();
+    if(n==0) return string(64,'0');
+    TraceSpan span("racine Merkle", "merkle", (int64_t)n);
+    ArenaScope scratch;
+    char* level = scratch.alloc<char>(64 * n);
+    string_view in[MERKLE_GROUP];
+    HashWords out[MERKLE_GROUP];
+    const AccountTable& names = accounts();
+    for (size_t g = 0; g < n; g += MERKLE_GROUP) {
+        ArenaScope encoded;
+        size_t m = min(MERKLE_GROUP, n - g);
+        for (size_t i = 0; i < m; ++i) {
+            size_t k = g + i;
+            const string& s = names.name(txs.senders[k]);
+            const string& r = names.name(txs.receivers[k]);
+            char* p = encoded.alloc<char>(20 + s.size() + r.size());
+            in[i] = string_view(p, encodeTx(txs.ids[k], s, r, txs.amounts[k], p) - p);
+        }
+        fastHashBatch(in, m, out);
+        for (size_t i = 0; i < m; ++i) writeHex(out[i], level + 64 * (g + i));
+    }
+    reduceMerkleLevel(level, n);
+    return string(level, 64);
+}
+
+vector<Amount> computeBalances(const Blockchain& bc) {
+    AccountId issuer = Blockchain::issuer();
+    vector<Amount> balances(accounts().size(), 0);
+    for (const auto& b : bc.chain.snapshot()) {
+        const TxColumns& t = b.transactions;
+        for (size_t k = 0; k < t.size(); ++k) {
+            if (t.senders[k] != issuer) balances[t.senders[k]] -= t.amounts[k];
+            balances[t.receivers[k]] += t.amounts[k];
+        }
+    }
+    return balances;
+}
+
+void encodeBlock(const BlockTx& b, string& out) { encodeBlock(b,out,[](AccountId id) -> const string& { return accounts().name(id); }); }
+
+bool decodeBlockHeader(const string& in, size_t& pos, BlockTx& b) {
+    size_t p=pos;
+    if(p>in.size() || in.size()-p<20) return false;
+    b.id=(int32_t)getLE(in.data()+p,4);
+    b.timestamp=(time_t)(int64_t)getLE(in.data()+p+4,8);
+    b.nonce=getLE(in.data()+p+12,8);
+    p+=20;
+    if(!getStr(in,p,b.prevHash) || !getStr(in,p,b.merkleRoot) || !getStr(in,p,b.validator) || !getStr(in,p,b.hash)) return false;
+    if(b.transactions.size()) b.transactions=TxColumns();
+    pos=p;
+    return true;
+}
+
+bool decodeBlock(const string& in, size_t& pos, BlockTx& b) {
+    size_t p=pos;
+    if(!decodeBlockHeader(in,p,b)) return false;
+    if(in.size()-p<4) return false;
+    size_t n=getLE(in.data()+p,4); p+=4;
+    b.transactions=TxColumns();
+    b.transactions.reserve(min(n,(in.size()-p)/20));
+    Transaction tx(0,(AccountId)0,(AccountId)0,(Amount)0);
+    for(size_t k=0;k<n;++k){ if(!decodeTx(in,p,tx)) return false; b.transactions.push(tx); }
+    pos=p;
+    return true;
+}
+
+bool& quietMode() { static bool quiet = false; return quiet; }
+
+string selectionPreimage(const string& prevHash, uint64_t slot) { return prevHash + ":" + to_string(slot); }
+
+uint64_t selectionSeed(const string& prevHash, uint64_t slot) {
+    ArenaScope scratch;
+    char* buf = scratch.alloc<char>(prevHash.size() + 21);
+    memcpy(buf, prevHash.data(), prevHash.size());
+    char* p = buf + prevHash.size();
+    *p++ = ':';
+    p = to_chars(p, p + 20, slot).ptr;
+    return fastHashWords(buf, p - buf).w[0];
+}
+
+string padLabel(const string& label, size_t width) {
+    size_t shown = 0;
+    for (unsigned char c : label) shown += (c & 0xC0) != 0x80;
+    return shown >= width ? label + " " : label + string(width - shown, ' ');
+}
+
+PerfCounters::PerfCounters() {
+#ifdef __linux__
+    const pair<uint32_t, uint64_t> events[PerfSample::COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        // Dernier niveau de cache, lectures manquées (PERF_COUNT_HW_CACHE_MISSES désigne, selon le
+        // processeur, un événement générique qui ne mesure pas forcément ce niveau)
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)}};
+    for (int k = 0; k < PerfSample::COUNT; ++k) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = events[k].first;
+        attr.config = events[k].second;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[k] < 0 && reason.empty()) reason = string("perf_event_open : ") + strerror(errno);
+    }
+#else
+    reason = "compteurs matériels disponibles sous Linux uniquement";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+    for (int fd : fds) if (fd >= 0) { ioctl(fd, PERF_EVENT_IOC_RESET, 0); ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); }
+#endif
+    alloc0 = threadAllocations();
+    t0 = steady_clock::now();
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample s;
+    s.ms = duration_cast<nanoseconds>(steady_clock::now() - t0).count() / 1e6;
+    s.allocs = threadAllocations() - alloc0;
+#ifdef __linux__
+    for (int k = 0; k < PerfSample::COUNT; ++k) {
+        if (fds[k] < 0) continue;
+        ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t buf[3]; // valeur, temps activé, temps réellement compté
+        if (read(fds[k], buf, sizeof buf) != (ssize_t)sizeof buf || buf[2] == 0) continue;
+        // Compteur multiplexé : extrapolation au temps total d'activation
+        s.value[k] = buf[2] < buf[1] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+        s.valid[k] = true;
+    }
+#endif
+    return s;
+}
+
+double threadCpuMs() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+#endif
+    return 1e3 * clock() / CLOCKS_PER_SEC;
+}
+
+namespace { thread_local const char* traceThreadName = nullptr; }
+
+Tracer& Tracer::instance() { static Tracer tracer; return tracer; }
+
+shared_ptr<Tracer::Buffer>& Tracer::threadBuffer() { thread_local shared_ptr<Buffer> mine; return mine; }
+
+void Tracer::nameThread(const char* name) {
+    traceThreadName = name;
+    if (Buffer* b = threadBuffer().get()) { lock_guard<mutex> lock(instance().mtx); b->threadName = name; }
+}
+
+Tracer::Buffer* Tracer::local() {
+    shared_ptr<Buffer>& mine = threadBuffer();
+    if (!mine) {
+        mine = make_shared<Buffer>();
+        lock_guard<mutex> lock(mtx);
+        mine->tid = nextTid++;
+        mine->threadName = traceThreadName;
+        buffers.push_back(mine);
+    }
+    return mine.get();
+}
+
+void Tracer::start(size_t eventsPerThread) {
+    lock_guard<mutex> lock(mtx);
+    capacity = max<size_t>(1, eventsPerThread);
+    // Tampons des threads terminés : le registre en est le dernier propriétaire
+    buffers.erase(remove_if(buffers.begin(), buffers.end(), [](const shared_ptr<Buffer>& b) { return b.use_count() == 1; }), buffers.end());
+    for (auto& b : buffers) { b->ring.clear(); b->next = 0; }
+    origin = nowNs();
+    on.store(true, memory_order_relaxed);
+}
+
+void Tracer::record(const char* name, const char* cat, uint64_t startNs, uint64_t endNs, int64_t arg) {
+    Buffer* b = local();
+    TraceEvent e{name, cat, startNs, endNs, arg};
+    if (b->ring.size() < capacity) b->ring.push_back(e);
+    else b->ring[b->next % capacity] = e;
+    ++b->next;
+}
+
+size_t Tracer::write(OutputSink& out) const {
+    lock_guard<mutex> lock(mtx);
+    // Temps en µs avec trois décimales (résolution ns) ; ts est relatif à start()
+    auto micros = [](char* p, uint64_t ns) {
+        p = to_chars(p, p + 24, ns / 1000).ptr;
+        unsigned f = (unsigned)(ns % 1000);
+        *p++ = '.'; *p++ = char('0' + f / 100); *p++ = char('0' + f / 10 % 10); *p++ = char('0' + f % 10);
+        return p;
+    };
+    auto text = [](char* p, const char* s) { size_t n = strlen(s); memcpy(p, s, n); return p + n; };
+    size_t events = 0;
+    bool first = true;
+    out.write(string("{\"traceEvents\":[\n"));
+    for (const auto& b : buffers) {
+        if (b->next == 0) continue;
+        char tid[16];
+        *to_chars(tid, tid + 15, b->tid).ptr = '\0';
+        string threadName = b->threadName ? b->threadName : "thread " + string(tid);
+        char* p = out.reserve(128 + threadName.size());
+        if (!first) p = text(p, ",\n");
+        first = false;
+        p = text(p, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"); p = text(p, tid);
+        p = text(p, ",\"args\":{\"name\":\""); p = text(p, threadName.c_str()); p = text(p, "\"}}");
+        out.commit(p);
+
+        size_t count = b->ring.size(), oldest = b->next > count ? b->next % capacity : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& e = b->ring[(oldest + i) % count];
+            p = out.reserve(192 + strlen(e.name) + strlen(e.cat));
+            p = text(p, ",\n{\"name\":\""); p = text(p, e.name);
+            p = text(p, "\",\"cat\":\""); p = text(p, e.cat);
+            p = text(p, "\",\"ph\":\"X\",\"pid\":1,\"tid\":"); p = text(p, tid);
+            p = text(p, ",\"ts\":"); p = micros(p, e.startNs > origin ? e.startNs - origin : 0);
+            p = text(p, ",\"dur\":"); p = micros(p, e.endNs - e.startNs);
+            if (e.arg >= 0) { p = text(p, ",\"args\":{\"n\":"); p = to_chars(p, p + 24, e.arg).ptr; *p++ = '}'; }
+            *p++ = '}';
+            out.commit(p);
+        }
+        events += count;
+    }
+    out.write(string("\n],\"displayTimeUnit\":\"ns\"}\n"));
+    return events;
+}
+
+size_t Tracer::writeFile(const string& path) const {
+    OutputSink sink(path);
+    size_t events = write(sink);
+    sink.flush();
+    if (!sink.ok()) throw runtime_error("écriture incomplète de " + path);
+    return events;
+}
+
+uint64_t Tracer::dropped() const {
+    lock_guard<mutex> lock(mtx);
+    uint64_t n = 0;
+    for (const auto& b : buffers) n += b->next - b->ring.size();
+    return n;
+}
+
+vector<pair<string,uint64_t>> networkValidators(const NetworkConfig& cfg) {
+    vector<pair<string,uint64_t>> stakes;
+    for (int i = 0; i < cfg.nodes; ++i) stakes.push_back({"node" + to_string(i), 100 * (uint64_t)(i + 1)});
+    return stakes;
+}
@@ -0,0 +1,3206 @@
+// Bibliothèque commune : hachage, arbre de Merkle, comptes et transactions, blocs, registre des
+// soldes, mempool, persistance, sélection PoS, politiques de consensus, pipeline, minage
+// asynchrone, réseau simulé, mesures et export. Liée par les exercices et ProgrammeComplet.
+#ifndef BLOCKCHAIN_CORE_H
+#define BLOCKCHAIN_CORE_H
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <random>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <unordered_set>
+
+using namespace std;
+using namespace chrono;
+
+// ===================== Traces chronologiques =====================
+
+// Intervalles (« spans ») au format Chrome trace-event, lisibles dans Perfetto ou about:tracing.
+// Chaque thread écrit dans son propre tampon circulaire, sans verrou : quand il est plein, les
+// événements les plus anciens sont écrasés (et comptés). Noms et catégories sont des littéraux,
+// seul leur pointeur est copié. Désactivé, un TraceSpan coûte une lecture atomique relâchée ;
+// compilé avec -DATELIER_NO_TRACE, plus rien du tout.
+struct TraceEvent {
+    const char* name;
+    const char* cat;
+    uint64_t startNs, endNs;
+    int64_t arg;               // < 0 : pas d'argument (sinon hauteur de bloc, nombre de transactions...)
+};
+
+class OutputSink;
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+#ifdef ATELIER_NO_TRACE
+    static constexpr bool enabled() { return false; }
+#else
+    static bool enabled() { return on.load(memory_order_relaxed); }
+#endif
+    static uint64_t nowNs() { return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count(); }
+
+    // Nom affiché pour le thread appelant (littéral) ; peut être donné avant start()
+    static void nameThread(const char* name);
+
+    // start vide les tampons (au plus eventsPerThread événements par thread) et active les traces ;
+    // stop et write supposent les threads tracés au repos (joints ou en attente).
+    void start(size_t eventsPerThread = 1 << 16);
+    void stop() { on.store(false, memory_order_relaxed); }
+
+    void record(const char* name, const char* cat, uint64_t startNs, uint64_t endNs, int64_t arg);
+
+    // JSON {"traceEvents":[...]} : noms des threads puis intervalles ("ph":"X"), temps en µs
+    size_t write(OutputSink& out) const;
+    size_t writeFile(const string& path) const;
+    uint64_t dropped() const;
+
+private:
+    struct Buffer {
+        vector<TraceEvent> ring;
+        uint64_t next = 0;         // événements écrits depuis start (rang modulo la capacité)
+        uint32_t tid = 0;
+        const char* threadName = nullptr;
+    };
+
+    inline static atomic<bool> on{false};
+    mutable mutex mtx;
+    vector<shared_ptr<Buffer>> buffers;
+    size_t capacity = 1 << 16;
+    uint64_t origin = 0;
+    uint32_t nextTid = 1;
+
+    static shared_ptr<Buffer>& threadBuffer();
+    Buffer* local();
+};
+
+// Intervalle couvrant la portée : TraceSpan span("racine Merkle", "merkle", txs.size());
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* spanName, const char* category = "bloc", int64_t value = -1)
+        : name(spanName), cat(category), arg(value), t0(Tracer::enabled() ? Tracer::nowNs() : 0) {}
+    ~TraceSpan() { if (t0 && Tracer::enabled()) Tracer::instance().record(name, cat, t0, Tracer::nowNs(), arg); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void setArg(int64_t a) { arg = a; }
+
+private:
+    const char* name;
+    const char* cat;
+    int64_t arg;
+    uint64_t t0;
+};
+
+// ===================== Mémoire temporaire =====================
+
+// Arène monotone : allocation par simple incrément dans de gros blocs, libération en bloc.
+// mark()/rewind() rendent d'un coup tout ce qui a été alloué depuis la marque ; les blocs sont
+// conservés, si bien qu'une fois l'arène chauffée les temporaires d'un bloc (préimages, niveaux
+// de Merkle, tableaux du registre) ne touchent plus à l'allocateur. Types trivialement destructibles.
+class Arena {
+public:
+    struct Mark { size_t chunk, used; };
+
+    explicit Arena(size_t chunkBytes = 256 << 10) : chunkSize(chunkBytes) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        size_t p = (used + align - 1) & ~(align - 1);
+        if (chunks.empty() || p + bytes > chunks[current].size) { nextChunk(bytes + align); p = 0; }
+        used = p + bytes;
+        return chunks[current].data.get() + p;
+    }
+    template<class T>
+    T* alloc(size_t n) {
+        static_assert(is_trivially_destructible<T>::value, "Arena : types trivialement destructibles uniquement");
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    Mark mark() const { return {current, used}; }
+    void rewind(Mark m) { current = m.chunk; used = m.used; }
+    void reset() { current = 0; used = 0; }
+    size_t reserved() const { size_t n = 0; for (auto& c : chunks) n += c.size; return n; }
+
+private:
+    struct Chunk { unique_ptr<char[]> data; size_t size; };
+    vector<Chunk> chunks;
+    size_t current = 0, used = 0, chunkSize;
+
+    // Bloc suivant déjà alloué s'il est assez grand, sinon un nouveau inséré à cette place
+    void nextChunk(size_t need) {
+        size_t next = chunks.empty() ? 0 : current + 1;
+        if (next == chunks.size() || chunks[next].size < need) {
+            size_t size = max(chunkSize, need);
+            chunks.insert(chunks.begin() + next, Chunk{unique_ptr<char[]>(new char[size]), size});
+        }
+        current = next;
+        used = 0;
+    }
+};
+
+// Arène de travail du thread appelant
+Arena& threadArena();
+
+// Portée temporaire : tout ce qui est alloué par alloc() est rendu à la sortie de la portée
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& a = threadArena()) : arena(a), start(a.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    template<class T> T* alloc(size_t n) { return arena.alloc<T>(n); }
+
+private:
+    Arena& arena;
+    Arena::Mark start;
+};
+
+// Comptabilité des allocations : compilé avec -DATELIER_ALLOC_STATS, l'opérateur new global est
+// remplacé (BlockchainCore.cpp) et compte, par thread, les allocations et les octets demandés.
+// Les écarts entre deux lectures donnent le trafic d'une phase (PhaseProfiler, étages du pipeline).
+// Sans ce drapeau l'allocateur reste celui du système et les compteurs restent à zéro.
+struct AllocSample {
+    uint64_t count = 0, bytes = 0;
+    AllocSample operator-(const AllocSample& o) const { return {count - o.count, bytes - o.bytes}; }
+    AllocSample& operator+=(const AllocSample& o) { count += o.count; bytes += o.bytes; return *this; }
+};
+
+// Cumul du thread appelant depuis son démarrage ; nul si !allocStatsAvailable()
+AllocSample threadAllocations();
+bool allocStatsAvailable();
+
+
+// Fonction de hachage rapide (réutilisée partout)
+
+// Mots de 64 bits du hash ; fastSHA256 en est l'écriture hexadécimale (64 caractères)
+struct HashWords { uint64_t w[4]; };
+
+HashWords fastHashWords(const char* data, size_t n);
+inline HashWords fastHashWords(const string& data) { return fastHashWords(data.data(), data.size()); }
+
+// Écriture hexadécimale (minuscules, 16 chiffres par mot) sans stringstream
+void writeHex(const HashWords& h, char* out);
+// Lecture inverse : false si hex ne fait pas 64 chiffres hexadécimaux minuscules
+bool parseHex(const string& hex, HashWords& out);
+
+string fastSHA256(const string& data);
+
+// Hachage par lots : LANES messages avancent ensemble, octet par octet. Les chaînes de
+// dépendances (multiplication de h1) sont indépendantes d'un message à l'autre et s'exécutent
+// en parallèle dans le pipeline ; 4 voies tiennent dans les registres (8 provoquent des
+// débordements sur x86-64). Résultat identique à fastHashWords pour chaque message.
+void fastHashBatch(const string* const* inputs, size_t n, HashWords* out);
+void fastHashBatch(const string_view* inputs, size_t n, HashWords* out);
+
+
+// Exercice 1 : Arbre de Merkle
+
+class Node {
+public:
+    string hash;
+    Node* left;
+    Node* right;
+
+    Node(const string& h) : hash(h), left(nullptr), right(nullptr) {}
+};
+
+class MerkleTree {
+private:
+    vector<Node*> leaves;
+    Node* root;
+    vector<Node*> owned; // un nœud dupliqué (niveau impair) a deux parents : libération par cette liste
+
+public:
+    MerkleTree(const vector<string>& transactions) {
+        buildTree(transactions);
+    }
+    ~MerkleTree() { for (Node* n : owned) delete n; }
+    MerkleTree(const MerkleTree&) = delete;
+    MerkleTree& operator=(const MerkleTree&) = delete;
+
+    void buildTree(vector<string> transactions) {
+        TraceSpan span("MerkleTree", "merkle", (int64_t)transactions.size());
+        if (transactions.empty()) {
+            root = nullptr;
+            return;
+        }
+
+        for (const auto& tx : transactions)
+            leaves.push_back(new Node(fastSHA256(tx)));
+        owned = leaves;
+
+        vector<Node*> currentLevel = leaves;
+
+        while (currentLevel.size() > 1) {
+            vector<Node*> newLevel;
+
+            for (size_t i = 0; i < currentLevel.size(); i += 2) {
+                if (i + 1 == currentLevel.size()) currentLevel.push_back(currentLevel[i]);
+
+                string combined = currentLevel[i]->hash + currentLevel[i + 1]->hash;
+                Node* parent = new Node(fastSHA256(combined));
+                owned.push_back(parent);
+                parent->left = currentLevel[i];
+                parent->right = currentLevel[i + 1];
+                newLevel.push_back(parent);
+            }
+            currentLevel = newLevel;
+        }
+        root = currentLevel[0];
+    }
+
+    string getRootHash() const {
+        return root ? root->hash : "";
+    }
+
+    void printTreeHorizontal(Node* node, int space = 0, int levelSpace = 6) const {
+        if (!node) return;
+        space += levelSpace;
+        printTreeHorizontal(node->right, space);
+        cout << endl;
+        for (int i = levelSpace; i < space; i++) cout << " ";
+        cout << node->hash.substr(0,6) << endl;
+        printTreeHorizontal(node->left, space);
+    }
+
+    void display() const {
+        cout << "\n===== Structure de l’Arbre de Merkle =====\n";
+        printTreeHorizontal(root);
+    }
+};
+
+
+
+// Racine Merkle d'une liste de chaînes (Exercice 2, et feuilles des blocs à transactions).
+// Les niveaux sont réduits sur place dans un seul tampon de l'arène du thread.
+string calculateMerkleRoot(const vector<string>& txs);
+
+// Classes communes pour ex 3 et 4
+
+// Comptes internés : chaque nom de compte n'est stocké qu'une fois
+// et les transactions ne manipulent que des identifiants entiers.
+typedef uint32_t AccountId;
+
+class AccountTable {
+private:
+    mutable shared_mutex mtx;
+    unordered_map<string,AccountId> ids;
+    deque<string> names; // deque : les références restent stables après push_back
+    deque<uint64_t> keys; // clé 64 bits du nom, indépendante de l'ordre d'internement
+
+public:
+    AccountId intern(const string& name) {
+        {
+            shared_lock<shared_mutex> lock(mtx);
+            auto it = ids.find(name);
+            if (it != ids.end()) return it->second;
+        }
+        unique_lock<shared_mutex> lock(mtx);
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        AccountId id = (AccountId)names.size();
+        names.push_back(name);
+        keys.push_back(fastHashWords(name).w[0]);
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    const string& name(AccountId id) const { shared_lock<shared_mutex> lock(mtx); return names[id]; }
+    // Recherche sans internement (requêtes) : false si le nom est inconnu
+    bool find(const string& name, AccountId& id) const {
+        shared_lock<shared_mutex> lock(mtx);
+        auto it = ids.find(name);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+    // Clés de n comptes sous un seul verrou (empreintes de transactions par lot)
+    void keysOf(const AccountId* id, size_t n, uint64_t* out) const {
+        shared_lock<shared_mutex> lock(mtx);
+        for (size_t i = 0; i < n; ++i) out[i] = keys[id[i]];
+    }
+    size_t size() const { shared_lock<shared_mutex> lock(mtx); return names.size(); }
+};
+
+AccountTable& accounts();
+
+// Montants en virgule fixe : 1 unité = 1e-8 (comme le satoshi)
+typedef int64_t Amount;
+const Amount AMOUNT_SCALE = 100000000;
+
+inline Amount toAmount(double value) { return (Amount)llround(value * AMOUNT_SCALE); }
+
+// Formatage texte sans stringstream : écrit dans [first,last) et renvoie la fin
+// (32 caractères suffisent toujours)
+char* formatAmount(char* first, char* last, Amount a);
+
+string formatAmount(Amount a);
+
+class Transaction {
+public:
+    int id;
+    AccountId sender;
+    AccountId receiver;
+    Amount amount;
+    Transaction(int i,const string& s,const string& r,double a):id(i),sender(accounts().intern(s)),receiver(accounts().intern(r)),amount(toAmount(a)){}
+    Transaction(int i,AccountId s,AccountId r,Amount a):id(i),sender(s),receiver(r),amount(a){}
+    string toString() const {
+        const string& s=accounts().name(sender); const string& r=accounts().name(receiver);
+        char buf[32]; string out; out.reserve(s.size()+r.size()+48);
+        out.append(buf,to_chars(buf,buf+sizeof(buf),id).ptr); out+=':'; out+=s; out+="->"; out+=r; out+=':';
+        out.append(buf,formatAmount(buf,buf+sizeof(buf),amount));
+        return out;
+    }
+};
+
+// Encodage binaire canonique (préimage des feuilles Merkle), entiers en little-endian :
+//   id (4) | len(sender) (4) | sender | len(receiver) (4) | receiver | amount (8)
+// On encode les noms et pas les AccountId : le résultat ne dépend pas de l'ordre d'internement.
+// Garantie : decodeTx(encodeTx(tx)) redonne exactement tx (id, comptes et montant).
+inline void putLE(string& out, uint64_t v, int bytes) { char b[8]; for(int i=0;i<bytes;++i) b[i]=(char)(v>>(8*i)); out.append(b,bytes); }
+inline uint64_t getLE(const char* p, int bytes) { uint64_t v=0; for(int i=0;i<bytes;++i) v|=(uint64_t)(unsigned char)p[i]<<(8*i); return v; }
+inline void putStr(string& out, const string& str) { putLE(out,str.size(),4); out+=str; }
+bool getStr(const string& in, size_t& p, string& str);
+
+void encodeTx(int id, const string& sender, const string& receiver, Amount amount, string& out);
+void encodeTx(const Transaction& tx, string& out);
+// Écriture directe dans un tampon de 20 + |sender| + |receiver| octets ; renvoie la fin
+char* encodeTx(int id, const string& sender, const string& receiver, Amount amount, char* out);
+
+string encodeTx(const Transaction& tx);
+size_t encodedTxSize(const Transaction& tx);
+
+// Décode une transaction à partir de pos (avancé en cas de succès) ; false si le tampon est tronqué
+bool decodeTx(const string& in, size_t& pos, Transaction& tx);
+
+// Stockage en colonnes (structure de tableaux) des transactions d'un bloc :
+// les parcours (soldes, volumes) ne lisent que les colonnes utiles.
+class TxColumns {
+public:
+    vector<int> ids;
+    vector<AccountId> senders;
+    vector<AccountId> receivers;
+    vector<Amount> amounts;
+
+    TxColumns() {}
+    TxColumns(const vector<Transaction>& txs) { reserve(txs.size()); for(auto& tx: txs) push(tx); }
+
+    void reserve(size_t n){ ids.reserve(n); senders.reserve(n); receivers.reserve(n); amounts.reserve(n); }
+    void push(const Transaction& tx){ ids.push_back(tx.id); senders.push_back(tx.sender); receivers.push_back(tx.receiver); amounts.push_back(tx.amount); }
+    size_t size() const { return ids.size(); }
+    Transaction get(size_t i) const { return Transaction(ids[i],senders[i],receivers[i],amounts[i]); }
+    size_t memoryBytes() const { return size()*(sizeof(int)+2*sizeof(AccountId)+sizeof(Amount)); }
+};
+
+// Racine Merkle d'un bloc : chaque feuille est le hash de l'encodage binaire de la transaction
+string computeTxMerkleRoot(const TxColumns& txs);
+
+class BlockTx {
+public:
+    int id;
+    time_t timestamp;
+    string prevHash;
+    string merkleRoot;
+    uint64_t nonce;
+    string validator;
+    string hash;
+    TxColumns transactions;
+
+    BlockTx() : id(0), timestamp(0), nonce(0) {} // pour la relecture depuis le disque
+    BlockTx(int i,string prev,TxColumns txs)
+        : id(i), timestamp(time(nullptr)), prevHash(prev), nonce(0), validator(""), transactions(std::move(txs)) {
+        merkleRoot = computeTxMerkleRoot(transactions);
+        calculateHash();
+    }
+    // Variante avec une racine Merkle déjà calculée (préparée en amont par le pipeline)
+    BlockTx(int i,string prev,TxColumns txs,string root)
+        : id(i), timestamp(time(nullptr)), prevHash(prev), merkleRoot(std::move(root)), nonce(0), validator(""), transactions(std::move(txs)) {
+        calculateHash();
+    }
+
+    // Préimage de l'en-tête (tout sauf les transactions, résumées par merkleRoot) :
+    // id | timestamp | prevHash | merkleRoot | nonce | validator
+    string headerData() const { string out; appendHeader(out); return out; }
+    // Même préimage, écrite dans un tampon réutilisé (vérification par lots, sans allocation)
+    void appendHeader(string& out) const {
+        size_t old = out.size();
+        out.resize(old + headerBound());
+        out.resize(writeHeader(&out[old]) - out.data());
+    }
+    // Taille maximale de la préimage, et écriture dans un tampon de cette taille (renvoie la fin)
+    size_t headerBound() const { return 3 * 20 + prevHash.size() + merkleRoot.size() + validator.size(); }
+    char* writeHeader(char* out) const { return writeHeaderSuffix(writeHeaderPrefix(out)); }
+
+    // Préimage écrite dans l'arène du thread et hash réécrit sur place : aucune allocation
+    HashWords headerHash() const {
+        ArenaScope scratch;
+        char* buf = scratch.alloc<char>(headerBound());
+        return fastHashWords(buf, writeHeader(buf) - buf);
+    }
+    void calculateHash() { setHash(headerHash()); }
+    // Le hash stocké correspond-il à l'en-tête ? (sans copier le bloc ni ses transactions)
+    bool hashMatches() const {
+        char hex[64];
+        writeHex(headerHash(), hex);
+        return hash.size() == 64 && memcmp(hash.data(), hex, 64) == 0;
+    }
+
+    // Le préfixe (id, timestamp, prevHash, merkleRoot) est écrit une fois ; à chaque essai seuls
+    // le nonce et le validateur sont réécrits à sa suite.
+    void mineBlock(int difficulty) {
+        TraceSpan span("minage PoW","minage",id);
+        ArenaScope scratch;
+        char* buf = scratch.alloc<char>(headerBound());
+        char* suffix = writeHeaderPrefix(buf);
+        auto solved = [&]{ for(int i=0;i<difficulty;++i) if(hash[i]!='0') return false; return true; };
+        do { ++nonce; setHash(fastHashWords(buf, writeHeaderSuffix(suffix) - buf)); } while(!solved());
+    }
+    void validatePoS(const string& validatorName){validator=validatorName;calculateHash();}
+    // Copie de l'en-tête seul (transactions vides) : suffit pour hacher et chercher un nonce
+    BlockTx header() const {
+        BlockTx h;
+        h.id=id; h.timestamp=timestamp; h.prevHash=prevHash; h.merkleRoot=merkleRoot;
+        h.nonce=nonce; h.validator=validator; h.hash=hash;
+        return h;
+    }
+
+private:
+    char* writeHeaderPrefix(char* out) const {
+        out = to_chars(out, out + 20, id).ptr;
+        out = to_chars(out, out + 20, (long long)timestamp).ptr;
+        memcpy(out, prevHash.data(), prevHash.size()); out += prevHash.size();
+        memcpy(out, merkleRoot.data(), merkleRoot.size()); return out + merkleRoot.size();
+    }
+    char* writeHeaderSuffix(char* out) const {
+        out = to_chars(out, out + 20, nonce).ptr;
+        memcpy(out, validator.data(), validator.size()); return out + validator.size();
+    }
+    void setHash(const HashWords& h) { hash.resize(64); writeHex(h, &hash[0]); }
+};
+
+// Barrière réutilisable (C++17 n'a pas std::barrier)
+class Barrier {
+private:
+    mutex mtx;
+    condition_variable cv;
+    unsigned count, waiting = 0;
+    uint64_t generation = 0;
+
+public:
+    explicit Barrier(unsigned n) : count(n) {}
+    void wait() {
+        unique_lock<mutex> lock(mtx);
+        uint64_t gen = generation;
+        if (++waiting == count) { waiting = 0; ++generation; cv.notify_all(); }
+        else cv.wait(lock, [&]{ return gen != generation; });
+    }
+};
+
+// Pool de threads de travail : exécute les tâches soumises dans l'ordre d'arrivée
+class WorkerPool {
+private:
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable cv;
+    deque<function<void()>> tasks;
+    bool stopping = false;
+
+public:
+    explicit WorkerPool(unsigned n = 0) {
+        if (n == 0) n = max(1u, thread::hardware_concurrency());
+        for (unsigned i = 0; i < n; ++i)
+            workers.emplace_back([this]{
+                Tracer::nameThread("pool");
+                for (;;) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> lock(mtx);
+                        cv.wait(lock, [&]{ return stopping || !tasks.empty(); });
+                        if (tasks.empty()) return;
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+    }
+
+    ~WorkerPool() {
+        { lock_guard<mutex> lock(mtx); stopping = true; }
+        cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    void submit(function<void()> task) {
+        { lock_guard<mutex> lock(mtx); tasks.push_back(std::move(task)); }
+        cv.notify_one();
+    }
+
+    unsigned size() const { return (unsigned)workers.size(); }
+};
+
+// Index des transactions vues : empreintes 64 bits (id, clés des noms de l'émetteur et du
+// destinataire, montant), stables d'une exécution à l'autre. Table à adressage ouvert (sondage
+// linéaire, remplie au plus à moitié) précédée d'un filtre de Bloom par mots de 64 bits : une
+// transaction neuve, le cas courant, est le plus souvent écartée par un seul mot du filtre, qui
+// tient en cache quand la table n'y tient plus. L'empreinte étant déjà uniformément répartie,
+// ses bits servent directement de sondes.
+// Les lectures (mark) et les insertions se font par bloc, sous un verrou partagé / exclusif.
+class SeenTxIndex {
+public:
+    static uint64_t digest(int id, uint64_t senderKey, uint64_t receiverKey, Amount amount) {
+        uint64_t h = mix((uint64_t)(uint32_t)id ^ 0x9e3779b97f4a7c15ULL);
+        h = mix(h ^ senderKey);
+        h = mix(h ^ (receiverKey * 0xbf58476d1ce4e5b9ULL));
+        h = mix(h ^ (uint64_t)amount);
+        return h ? h : 1; // 0 marque une case vide
+    }
+    static uint64_t digest(const Transaction& tx) {
+        uint64_t k[2];
+        AccountId who[2] = {tx.sender, tx.receiver};
+        accounts().keysOf(who, 2, k);
+        return digest(tx.id, k[0], k[1], tx.amount);
+    }
+    // Empreintes des transactions d'un bloc (out : txs.size() cases)
+    static void digests(const TxColumns& txs, uint64_t* out) {
+        size_t n = txs.size();
+        ArenaScope scratch;
+        uint64_t* sk = scratch.alloc<uint64_t>(n);
+        uint64_t* rk = scratch.alloc<uint64_t>(n);
+        accounts().keysOf(txs.senders.data(), n, sk);
+        accounts().keysOf(txs.receivers.data(), n, rk);
+        for (size_t k = 0; k < n; ++k) out[k] = digest(txs.ids[k], sk[k], rk[k], txs.amounts[k]);
+    }
+    // dup[k] = 1 pour chaque empreinte répétant une empreinte antérieure du même lot
+    static void markRepeats(const uint64_t* d, size_t n, char* dup) {
+        ArenaScope scratch;
+        size_t cap = 16;
+        while (cap < 2 * n) cap <<= 1;
+        uint64_t* slots = scratch.alloc<uint64_t>(cap);
+        fill_n(slots, cap, 0);
+        for (size_t k = 0; k < n; ++k) {
+            size_t i = d[k] & (cap - 1);
+            while (slots[i] && slots[i] != d[k]) i = (i + 1) & (cap - 1);
+            if (slots[i]) dup[k] = 1; else slots[i] = d[k];
+        }
+    }
+
+    SeenTxIndex() { rehash(1024); }
+    SeenTxIndex(const SeenTxIndex& o) { *this = o; }
+    SeenTxIndex& operator=(const SeenTxIndex& o) {
+        if (this == &o) return *this;
+        shared_lock<shared_mutex> lock(o.mtx);
+        slots = o.slots; bloom = o.bloom; count = o.count; bloomShift = o.bloomShift;
+        return *this;
+    }
+
+    bool contains(uint64_t d) const { shared_lock<shared_mutex> lock(mtx); return find(d); }
+    // false si l'empreinte était déjà présente
+    bool insert(uint64_t d) { unique_lock<shared_mutex> lock(mtx); return add(d); }
+    void insert(const uint64_t* d, size_t n) {
+        unique_lock<shared_mutex> lock(mtx);
+        // Agrandie une seule fois pour le lot (rechargement d'un snapshot), pas par doublements successifs
+        size_t cap = slots.size();
+        while (cap < 2 * (count + n)) cap <<= 1;
+        if (cap != slots.size()) rehash(cap);
+        for (size_t k = 0; k < n; ++k) add(d[k]);
+    }
+    void insertBlock(const TxColumns& txs) {
+        ArenaScope scratch;
+        uint64_t* d = scratch.alloc<uint64_t>(txs.size());
+        digests(txs, d);
+        insert(d, txs.size());
+    }
+    // dup[k] = 1 pour chaque empreinte déjà présente dans l'index
+    void mark(const uint64_t* d, size_t n, char* dup) const {
+        shared_lock<shared_mutex> lock(mtx);
+        for (size_t k = 0; k < n; ++k) if (find(d[k])) dup[k] = 1;
+    }
+    // Indices croissants des transactions déjà vues ou répétées dans le bloc ; 0 si le bloc est neuf
+    size_t findDuplicates(const TxColumns& txs, vector<size_t>* out = nullptr) const {
+        size_t n = txs.size(), found = 0;
+        ArenaScope scratch;
+        uint64_t* d = scratch.alloc<uint64_t>(n);
+        char* dup = scratch.alloc<char>(n);
+        fill_n(dup, n, 0);
+        digests(txs, d);
+        mark(d, n, dup);
+        markRepeats(d, n, dup);
+        for (size_t k = 0; k < n; ++k) if (dup[k]) { ++found; if (out) out->push_back(k); }
+        return found;
+    }
+
+    void clear() { unique_lock<shared_mutex> lock(mtx); slots.clear(); rehash(1024); count = 0; }
+    // Empreintes présentes, dans l'ordre de la table (sauvegarde dans un snapshot)
+    vector<uint64_t> entries() const {
+        shared_lock<shared_mutex> lock(mtx);
+        vector<uint64_t> out;
+        out.reserve(count);
+        for (uint64_t d : slots) if (d) out.push_back(d);
+        return out;
+    }
+    size_t size() const { shared_lock<shared_mutex> lock(mtx); return count; }
+    size_t memoryBytes() const { shared_lock<shared_mutex> lock(mtx); return (slots.capacity() + bloom.capacity()) * sizeof(uint64_t); }
+
+private:
+    mutable shared_mutex mtx;
+    vector<uint64_t> slots;  // 0 : case vide
+    vector<uint64_t> bloom;  // un mot pour 8 cases (16 à 32 bits par empreinte)
+    size_t count = 0;
+    int bloomShift = 64;
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+        return x ^ (x >> 33);
+    }
+    // 4 bits du mot choisis par des tranches de 6 bits du haut de l'empreinte ; le mot lui-même
+    // par hachage multiplicatif (la table utilise les bits bas)
+    static uint64_t bloomMask(uint64_t d) {
+        return (1ULL << ((d >> 40) & 63)) | (1ULL << ((d >> 46) & 63)) | (1ULL << ((d >> 52) & 63)) | (1ULL << (d >> 58));
+    }
+    size_t bloomWord(uint64_t d) const { return (d * 0x9e3779b97f4a7c15ULL) >> bloomShift; }
+
+    bool find(uint64_t d) const {
+        uint64_t m = bloomMask(d);
+        if ((bloom[bloomWord(d)] & m) != m) return false;
+        size_t mask = slots.size() - 1;
+        for (size_t i = d & mask; slots[i]; i = (i + 1) & mask) if (slots[i] == d) return true;
+        return false;
+    }
+    bool add(uint64_t d) {
+        if (2 * (count + 1) > slots.size()) rehash(slots.size() * 2);
+        size_t mask = slots.size() - 1, i = d & mask;
+        for (; slots[i]; i = (i + 1) & mask) if (slots[i] == d) return false;
+        slots[i] = d;
+        bloom[bloomWord(d)] |= bloomMask(d);
+        ++count;
+        return true;
+    }
+    // Capacité en puissance de deux (au moins 8 mots de filtre) ; réinsère les empreintes présentes
+    void rehash(size_t capacity) {
+        vector<uint64_t> old;
+        old.swap(slots);
+        slots.assign(capacity, 0);
+        bloom.assign(capacity / 8, 0);
+        bloomShift = 64;
+        for (size_t w = bloom.size(); w > 1; w >>= 1) --bloomShift;
+        size_t mask = capacity - 1;
+        for (uint64_t d : old) {
+            if (!d) continue;
+            size_t i = d & mask;
+            while (slots[i]) i = (i + 1) & mask;
+            slots[i] = d;
+            bloom[bloomWord(d)] |= bloomMask(d);
+        }
+    }
+};
+
+// Registre des soldes : applique les transactions d'un bloc en un seul lot et refuse les découverts
+class Ledger {
+public:
+    vector<Amount> balances; // indexé par AccountId
+
+    static constexpr size_t PARALLEL_MIN_TXS = 1 << 14;  // en dessous : application séquentielle
+    static constexpr size_t PARALLEL_MIN_WAVE = 2048;    // vagues plus petites : exécutées par un seul thread
+
+    Amount balance(AccountId a) const { return a < balances.size() ? balances[a] : 0; }
+    void credit(AccountId a, Amount v) { if (a >= balances.size()) balances.resize(a + 1, 0); balances[a] += v; }
+
+    // Sémantique séquentielle : les transactions sont évaluées dans l'ordre du bloc et une
+    // transaction est refusée si son montant est négatif, dépasse le solde de l'émetteur ou ferait
+    // déborder celui du destinataire. Le bloc est atomique : au moindre refus rien n'est appliqué, rejected reçoit les indices
+    // fautifs et false est renvoyé.
+    // En parallèle, les transactions sont réparties en vagues : chacune va dans la vague suivant
+    // la dernière qui a touché son émetteur ou son destinataire. Les transactions d'une même vague
+    // portent sur des comptes disjoints et s'exécutent en parallèle ; seules celles qui partagent
+    // un compte sont sérialisées, dans leur ordre d'origine.
+    bool applyBlock(const TxColumns& txs, vector<size_t>* rejected = nullptr, unsigned threads = 0) {
+        size_t n = txs.size();
+        TraceSpan span("registre", "validation", (int64_t)n);
+        if (balances.size() < accounts().size()) balances.resize(accounts().size(), 0);
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        // Temporaires du bloc dans l'arène du thread appelant, rendus à la sortie
+        ArenaScope scratch;
+        char* ok = scratch.alloc<char>(n);
+        fill_n(ok, n, 0);
+        auto applyOne = [&](size_t k) {
+            AccountId s = txs.senders[k], r = txs.receivers[k];
+            Amount a = txs.amounts[k];
+            // Découvert de l'émetteur ou solde du destinataire qui déborderait : refus
+            if (a < 0 || balances[s] < a || balances[r] > numeric_limits<Amount>::max() - a) return;
+            balances[s] -= a;
+            balances[r] += a;
+            ok[k] = 1;
+        };
+
+        if (n < PARALLEL_MIN_TXS || threads == 1) {
+            for (size_t k = 0; k < n; ++k) applyOne(k);
+        } else {
+            uint32_t* lastWave = scratch.alloc<uint32_t>(balances.size());
+            uint32_t* wave = scratch.alloc<uint32_t>(n);
+            fill_n(lastWave, balances.size(), 0);
+            uint32_t nWaves = 0;
+            for (size_t k = 0; k < n; ++k) {
+                AccountId s = txs.senders[k], r = txs.receivers[k];
+                uint32_t w = max(lastWave[s], lastWave[r]) + 1;
+                lastWave[s] = lastWave[r] = w;
+                wave[k] = w - 1;
+                nWaves = max(nWaves, w);
+            }
+            // Tri par comptage : indices de chaque vague, dans l'ordre d'origine
+            size_t* start = scratch.alloc<size_t>(nWaves + 1);
+            size_t* order = scratch.alloc<size_t>(n);
+            size_t* pos = scratch.alloc<size_t>(nWaves);
+            fill_n(start, nWaves + 1, 0);
+            for (size_t k = 0; k < n; ++k) ++start[wave[k] + 1];
+            for (uint32_t w = 0; w < nWaves; ++w) start[w + 1] += start[w];
+            copy(start, start + nWaves, pos);
+            for (size_t k = 0; k < n; ++k) order[pos[wave[k]]++] = k;
+
+            // Étapes : une grande vague en parallèle, ou une suite de petites vagues en séquentiel
+            struct Step { size_t begin, end; bool parallel; };
+            Step* steps = scratch.alloc<Step>(nWaves);
+            size_t nSteps = 0;
+            for (uint32_t w = 0; w < nWaves; ++w) {
+                bool big = start[w + 1] - start[w] >= PARALLEL_MIN_WAVE;
+                if (!big && nSteps && !steps[nSteps - 1].parallel) steps[nSteps - 1].end = start[w + 1];
+                else steps[nSteps++] = {start[w], start[w + 1], big};
+            }
+
+            // Threads auxiliaires pris dans un pool persistant : créer et joindre des threads à
+            // chaque bloc coûterait plus que le gain des vagues. Les vagues avancent par barrière,
+            // donc tous les participants doivent tourner ensemble : un seul bloc à la fois.
+            static mutex poolMtx;
+            static unique_ptr<WorkerPool> pool;
+            lock_guard<mutex> poolLock(poolMtx);
+            if (!pool || pool->size() < threads - 1) pool.reset(new WorkerPool(threads - 1));
+
+            Barrier barrier(threads);
+            auto worker = [&](unsigned t) {
+                TraceSpan waves("vagues", "validation", (int64_t)nSteps);
+                for (size_t k = 0; k < nSteps; ++k) {
+                    const Step& st = steps[k];
+                    if (st.parallel) {
+                        size_t len = st.end - st.begin;
+                        size_t b = st.begin + len * t / threads, e = st.begin + len * (t + 1) / threads;
+                        for (size_t i = b; i < e; ++i) applyOne(order[i]);
+                    } else if (t == 0) {
+                        for (size_t i = st.begin; i < st.end; ++i) applyOne(order[i]);
+                    }
+                    barrier.wait();
+                }
+            };
+            mutex doneMtx;
+            condition_variable doneCv;
+            unsigned running = threads - 1;
+            for (unsigned t = 1; t < threads; ++t)
+                pool->submit([&, t]{ worker(t); lock_guard<mutex> lock(doneMtx); if (--running == 0) doneCv.notify_one(); });
+            worker(0);
+            unique_lock<mutex> lock(doneMtx);
+            doneCv.wait(lock, [&]{ return running == 0; });
+        }
+
+        bool allOk = true;
+        for (size_t k = 0; k < n; ++k) if (!ok[k]) { allOk = false; if (rejected) rejected->push_back(k); }
+        if (!allOk) {
+            for (size_t k = 0; k < n; ++k) if (ok[k]) { balances[txs.senders[k]] += txs.amounts[k]; balances[txs.receivers[k]] -= txs.amounts[k]; }
+        }
+        return allOk;
+    }
+};
+
+// Récupération différée par époques : un lecteur épingle l'époque courante le temps de sa lecture
+// (deux accès atomiques, sans verrou ni boucle) ; l'écrivain qui détache une structure la confie
+// à retire, et elle n'est libérée qu'une fois sortis tous les lecteurs épinglés avant le détachement.
+// Un emplacement par thread lecteur, au plus MAX_THREADS simultanément ; les épinglages s'imbriquent.
+class Epochs {
+public:
+    static constexpr size_t MAX_THREADS = 256;
+
+    class Guard {
+    public:
+        Guard() { pin(); }
+        ~Guard() { if (active) unpin(); }
+        Guard(Guard&& o) noexcept : active(o.active) { o.active = false; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+    private:
+        bool active = true;
+    };
+
+    // reclaim est appelé (par l'écrivain, lors d'un retire ou d'un collect ultérieur) quand plus
+    // aucun lecteur ne peut voir la structure détachée
+    static void retire(function<void()> reclaim) {
+        {
+            lock_guard<mutex> lock(limboMtx);
+            limbo.push_back({epoch.fetch_add(1), std::move(reclaim)});
+        }
+        collect();
+    }
+
+    // Libère ce qui peut l'être ; renvoie le nombre de structures encore en attente
+    static size_t collect() {
+        uint64_t oldest = IDLE;
+        for (size_t t = 0; t < MAX_THREADS; ++t) oldest = min(oldest, slots()[t].epoch.load());
+        vector<function<void()>> ready;
+        size_t left;
+        {
+            lock_guard<mutex> lock(limboMtx);
+            auto freed = stable_partition(limbo.begin(), limbo.end(), [&](const Retired& r) { return r.first >= oldest; });
+            for (auto it = freed; it != limbo.end(); ++it) ready.push_back(std::move(it->second));
+            limbo.erase(freed, limbo.end());
+            left = limbo.size();
+        }
+        for (auto& f : ready) f();
+        return left;
+    }
+
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+    typedef pair<uint64_t, function<void()>> Retired; // époque du détachement, libération
+    struct alignas(64) Slot { atomic<uint64_t> epoch{IDLE}; atomic<bool> used{false}; };
+    struct Local {
+        Slot* slot = nullptr;
+        int depth = 0;
+        ~Local() { if (slot) slot->used.store(false, memory_order_release); }
+    };
+
+    inline static atomic<uint64_t> epoch{1};
+    inline static mutex limboMtx;
+    inline static vector<Retired> limbo;
+
+    static Slot* slots() { static Slot s[MAX_THREADS]; return s; }
+    static Local& local() { thread_local Local l; return l; }
+    static void pin() {
+        Local& l = local();
+        if (l.depth++) return;
+        if (!l.slot) l.slot = claim();
+        l.slot->epoch.store(epoch.load());
+    }
+    static void unpin() {
+        Local& l = local();
+        if (--l.depth == 0) l.slot->epoch.store(IDLE, memory_order_release);
+    }
+    static Slot* claim() {
+        for (size_t t = 0; t < MAX_THREADS; ++t) {
+            Slot& s = slots()[t];
+            bool expected = false;
+            if (!s.used.load(memory_order_relaxed) && s.used.compare_exchange_strong(expected, true)) return &s;
+        }
+        throw runtime_error("Epochs : trop de threads lecteurs simultanés");
+    }
+};
+
+// Chaîne partagée entre un écrivain et des lecteurs concurrents. Les blocs sont rangés dans des
+// segments de tailles doublées (64, 64, 128, 256...) qui ne bougent jamais : un bloc publié garde
+// son adresse et n'est plus modifié. L'écrivain construit le bloc puis publie la nouvelle hauteur
+// (release) ; un lecteur lit la hauteur (acquire) et ne touche qu'aux blocs en dessous, sans verrou
+// ni attente, pendant que les ajouts continuent. clear détache toute la génération (segments et
+// blocs) et la confie à Epochs : un snapshot pris avant reste lisible jusqu'à sa destruction.
+// Les accès directs (operator[], back, itération) sont ceux de l'écrivain, ou de lecteurs sans
+// clear concurrent ; les lecteurs d'une chaîne vivante passent par snapshot().
+// L'ajout est réservé à Blockchain : un bloc n'entre dans la chaîne que validé par addBlock.
+class ConcurrentChain {
+private:
+    friend class Blockchain;
+    static constexpr size_t FIRST = 64, MAX_SEGMENTS = 40;
+
+    struct Generation {
+        atomic<BlockTx*> segments[MAX_SEGMENTS] = {};
+        atomic<size_t> count{0};
+        ~Generation() {
+            size_t n = count.load();
+            for (size_t i = 0; i < n; ++i) at(this, i).~BlockTx();
+            for (auto& seg : segments) if (BlockTx* p = seg.load()) ::operator delete(p);
+        }
+    };
+
+    atomic<Generation*> gen;
+
+    static size_t segmentSize(size_t k) { return k == 0 ? FIRST : FIRST << (k - 1); }
+    static void locate(size_t i, size_t& k, size_t& offset) {
+        if (i < FIRST) { k = 0; offset = i; return; }
+        int e = 63 - __builtin_clzll(i / FIRST);
+        k = e + 1;
+        offset = i - (FIRST << e);
+    }
+    static const BlockTx& at(const Generation* g, size_t i) {
+        size_t k, offset;
+        locate(i, k, offset);
+        return g->segments[k].load(memory_order_relaxed)[offset];
+    }
+    BlockTx* slotFor(Generation* g, size_t i) {
+        size_t k, offset;
+        locate(i, k, offset);
+        BlockTx* seg = g->segments[k].load(memory_order_relaxed);
+        if (!seg) {
+            seg = static_cast<BlockTx*>(::operator new(segmentSize(k) * sizeof(BlockTx)));
+            g->segments[k].store(seg, memory_order_release);
+        }
+        return seg + offset;
+    }
+
+public:
+    class const_iterator {
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef BlockTx value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const BlockTx* pointer;
+        typedef const BlockTx& reference;
+        const_iterator(const Generation* gen, size_t index) : g(gen), i(index) {}
+        const BlockTx& operator*() const { return at(g, i); }
+        const BlockTx* operator->() const { return &at(g, i); }
+        const_iterator& operator++() { ++i; return *this; }
+        bool operator==(const const_iterator& o) const { return i == o.i; }
+        bool operator!=(const const_iterator& o) const { return i != o.i; }
+    private:
+        const Generation* g;
+        size_t i;
+    };
+
+    // Vue figée à une hauteur : les blocs [0, size()) restent lisibles tant que la vue existe
+    class Snapshot {
+    public:
+        explicit Snapshot(const ConcurrentChain& c) : g(c.gen.load()), height(g->count.load(memory_order_acquire)) {}
+        size_t size() const { return height; }
+        bool empty() const { return height == 0; }
+        const BlockTx& operator[](size_t i) const { return at(g, i); }
+        const BlockTx& back() const { return at(g, height - 1); }
+        const_iterator begin() const { return const_iterator(g, 0); }
+        const_iterator end() const { return const_iterator(g, height); }
+    private:
+        Epochs::Guard guard; // épinglé avant la lecture de la génération
+        const Generation* g;
+        size_t height;
+    };
+
+    ConcurrentChain() : gen(new Generation) {}
+    ConcurrentChain(const ConcurrentChain& o) : gen(new Generation) { for (const BlockTx& b : o.snapshot()) push_back(b); }
+    ConcurrentChain& operator=(const ConcurrentChain& o) {
+        if (this == &o) return *this;
+        clear();
+        for (const BlockTx& b : o.snapshot()) push_back(b);
+        return *this;
+    }
+    ~ConcurrentChain() { delete gen.load(); Epochs::collect(); }
+
+    Snapshot snapshot() const { return Snapshot(*this); }
+
+    // Alloue d'avance les segments des n premiers blocs
+    void reserve(size_t n) {
+        Generation* g = gen.load(memory_order_relaxed);
+        for (size_t k = 0, start = 0; k < MAX_SEGMENTS && start < n; start += segmentSize(k), ++k) slotFor(g, start);
+    }
+    void clear() {
+        Generation* old = gen.exchange(new Generation);
+        Epochs::retire([old] { delete old; });
+    }
+
+    size_t size() const { return gen.load()->count.load(memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const {
+        const Generation* g = gen.load();
+        size_t n = 0;
+        for (size_t k = 0; k < MAX_SEGMENTS; ++k) if (g->segments[k].load()) n += segmentSize(k);
+        return n;
+    }
+    const BlockTx& operator[](size_t i) const { return at(gen.load(), i); }
+    const BlockTx& back() const { return (*this)[size() - 1]; }
+    const_iterator begin() const { return const_iterator(gen.load(), 0); }
+    const_iterator end() const { const Generation* g = gen.load(); return const_iterator(g, g->count.load(memory_order_acquire)); }
+
+private:
+    // Écrivain unique
+    template<class... Args>
+    const BlockTx& emplace_back(Args&&... args) {
+        Generation* g = gen.load(memory_order_relaxed);
+        size_t n = g->count.load(memory_order_relaxed);
+        BlockTx* slot = new (slotFor(g, n)) BlockTx(std::forward<Args>(args)...);
+        g->count.store(n + 1, memory_order_release);
+        return *slot;
+    }
+    void push_back(const BlockTx& b) { emplace_back(b); }
+    void push_back(BlockTx&& b) { emplace_back(std::move(b)); }
+};
+
+class Blockchain {
+public:
+    ConcurrentChain chain; // lecteurs concurrents des ajouts : chain.snapshot()
+    Ledger ledger;
+    SeenTxIndex seen; // empreintes des transactions incluses : refus des rejeux
+
+    // allocations : soldes initiaux émis par le bloc genesis (depuis le compte "Genesis")
+    static AccountId issuer(){ return accounts().intern("Genesis"); }
+    Blockchain(const vector<pair<string,double>>& allocations = {}){
+        vector<Transaction> genesisTx = {Transaction(0,"Genesis","Network",0)};
+        for(auto& a: allocations) genesisTx.push_back(Transaction(0,"Genesis",a.first,a.second));
+        chain.push_back(BlockTx(0,string(64,'0'),genesisTx));
+        const TxColumns& g=chain[0].transactions;
+        for(size_t k=0;k<g.size();++k) ledger.credit(g.receivers[k],g.amounts[k]);
+        seen.insertBlock(g);
+    }
+    // Le bloc n'est ajouté que s'il prolonge la pointe (prevHash et hauteur), si aucune transaction
+    // n'est un rejeu (déjà incluse, ou répétée dans le bloc) et si le registre les accepte toutes
+    bool addBlock(BlockTx& b){
+        TraceSpan span("ajout bloc","validation",b.id);
+        const BlockTx& tip=chain.back();
+        if(b.prevHash!=tip.hash || b.id!=tip.id+1) return false;
+        if(seen.findDuplicates(b.transactions) || !ledger.applyBlock(b.transactions)) return false;
+        seen.insertBlock(b.transactions);
+        chain.push_back(b);
+        return true;
+    }
+    // Chaînage, hashes et absence de rejeu : l'index des transactions est reconstruit pendant le parcours
+    bool isValid() const {
+        auto view=chain.snapshot();
+        TraceSpan span("validation chaîne","validation",(int64_t)view.size());
+        SeenTxIndex walked;
+        for(size_t i=0;i<view.size();++i){
+            if(i>0 && (view[i].prevHash!=view[i-1].hash || !view[i].hashMatches())) return false;
+            if(walked.findDuplicates(view[i].transactions)) return false;
+            walked.insertBlock(view[i].transactions);
+        }
+        return true;
+    }
+    // Bloc formaté dans une seule chaîne puis écrit en une fois (préfixes de hash sans substr)
+    void printBlock(const BlockTx& b){
+        TraceSpan span("affichage bloc","sortie",b.id);
+        auto prefix=[](const string& h){ return string_view(h).substr(0,20); };
+        string out;
+        out.reserve(256+b.transactions.size()*48);
+        out+="Bloc ID: "; out+=to_string(b.id);
+        out+="\n  Timestamp: "; out+=to_string((long long)b.timestamp);
+        out+="\n  PrevHash: "; out+=prefix(b.prevHash);
+        out+="...\n  MerkleRoot: "; out+=prefix(b.merkleRoot);
+        out+="...\n  Nonce: "; out+=to_string(b.nonce);
+        out+="\n  Validator: "; out+=b.validator.empty()?"N/A":b.validator;
+        out+="\n  Hash: "; out+=prefix(b.hash);
+        out+="...\n  Transactions:\n";
+        for(size_t k=0;k<b.transactions.size();++k){ out+="    "; out+=b.transactions.get(k).toString(); out+='\n'; }
+        out+="--------------------------------------\n";
+        cout.write(out.data(),out.size());
+    }
+
+private:
+    friend class ChainStorage;
+    // Ancre de confiance d'une chaîne vidée (genesis ou bloc d'un snapshot) : registre et index
+    // sont reconstruits par l'appelant
+    void anchor(const BlockTx& b){ chain.push_back(b); }
+};
+
+// Soldes nets par compte : un seul parcours des colonnes de chaque bloc. L'émetteur du genesis
+// n'est pas débité (sa dette, somme de toutes les allocations, n'a pas de sens comme solde)
+vector<Amount> computeBalances(const Blockchain& bc);
+
+// Mempool concurrent : ingestion par plusieurs producteurs, répartie en shards.
+// Chaque shard a son verrou, l'ensemble des ids en attente et une file FIFO par niveau de frais
+// (map triée par frais décroissants) : prendre la meilleure transaction coûte O(1) amorti,
+// sans les défauts de cache d'un tas binaire. Une transaction va toujours dans le shard
+// de son id, ce qui suffit pour dédupliquer ; le nettoyage de l'ensemble des ids est
+// reporté sur les producteurs pour garder l'assemblage hors du chemin critique.
+// Avec l'index de la chaîne, les transactions déjà incluses sont refusées dès la soumission.
+class Mempool {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    Mempool() = default;
+    explicit Mempool(const SeenTxIndex& chainSeen) : seen(&chainSeen) {}
+
+    // false si une transaction de même id est déjà en attente, ou si elle est déjà dans la chaîne
+    bool submit(const Transaction& tx, Amount fee) {
+        if (seen && seen->contains(SeenTxIndex::digest(tx))) return false;
+        Shard& sh = shards[shardOf(tx.id)];
+        lock_guard<mutex> lock(sh.mtx);
+        if (!sh.taken.empty()) { for (int id : sh.taken) sh.ids.erase(id); sh.taken.clear(); }
+        if (!sh.ids.insert(tx.id).second) return false;
+        sh.levels[fee].push_back({tx, nextSeq++});
+        ++sh.count;
+        return true;
+    }
+
+    // Gabarit de bloc : transactions par frais décroissants (à frais égaux, ordre d'arrivée),
+    // au plus maxCount transactions et maxBytes octets encodés ; on s'arrête à la première
+    // transaction qui ne tient plus. Les transactions retenues quittent le mempool.
+    // Chaque shard cède ses meilleures transactions par lots, sous son seul verrou ; les lots sont
+    // fusionnés hors verrou et un shard n'est relu que lorsque son lot est épuisé. Les transactions
+    // non retenues reprennent leur place en tête de leur niveau.
+    TxColumns buildTemplate(size_t maxCount, size_t maxBytes = SIZE_MAX, Amount* totalFees = nullptr) {
+        deque<Pending> batch[SHARDS];
+        vector<int> taken[SHARDS];
+        size_t batchSize = max<size_t>(32, maxCount / SHARDS + 1);
+        auto worse = [&](size_t a, size_t b) {
+            const Pending& x = batch[a].front(); const Pending& y = batch[b].front();
+            return x.fee != y.fee ? x.fee < y.fee : x.seq > y.seq;
+        };
+        priority_queue<size_t, vector<size_t>, decltype(worse)> heads(worse);
+        for (size_t i = 0; i < SHARDS; ++i) {
+            takeBest(shards[i], min(batchSize, maxCount), batch[i]);
+            if (!batch[i].empty()) heads.push(i);
+        }
+
+        TxColumns out;
+        size_t bytes = 0;
+        Amount fees = 0;
+        while (out.size() < maxCount && !heads.empty()) {
+            size_t i = heads.top();
+            const Pending& p = batch[i].front();
+            if (maxBytes != SIZE_MAX) {
+                size_t sz = encodedTxSize(p.tx);
+                if (bytes + sz > maxBytes) break;
+                bytes += sz;
+            }
+            heads.pop();
+            fees += p.fee;
+            out.push(p.tx);
+            taken[i].push_back(p.tx.id);
+            batch[i].pop_front();
+            if (batch[i].empty() && out.size() < maxCount) takeBest(shards[i], min(batchSize, maxCount - out.size()), batch[i]);
+            if (!batch[i].empty()) heads.push(i);
+        }
+
+        for (size_t i = 0; i < SHARDS; ++i) {
+            if (batch[i].empty() && taken[i].empty()) continue;
+            Shard& sh = shards[i];
+            lock_guard<mutex> lock(sh.mtx);
+            sh.taken.insert(sh.taken.end(), taken[i].begin(), taken[i].end());
+            for (auto it = batch[i].rbegin(); it != batch[i].rend(); ++it) sh.levels[it->fee].push_front({it->tx, it->seq});
+            sh.count += batch[i].size();
+        }
+        if (totalFees) *totalFees = fees;
+        return out;
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (auto& sh : shards) { lock_guard<mutex> lock(sh.mtx); n += sh.count; }
+        return n;
+    }
+
+private:
+    struct Entry { Transaction tx; uint64_t seq; };           // seq : ordre d'arrivée global
+    struct Pending { Transaction tx; uint64_t seq; Amount fee; };
+
+    struct alignas(64) Shard {
+        mutable mutex mtx;
+        map<Amount, deque<Entry>, greater<Amount>> levels;
+        unordered_set<int> ids;
+        vector<int> taken; // ids sortis par buildTemplate, retirés de ids au prochain submit
+        size_t count = 0;
+    };
+
+    Shard shards[SHARDS];
+    atomic<uint64_t> nextSeq{0};
+    const SeenTxIndex* seen = nullptr;
+
+    static size_t shardOf(int id) { return ((uint32_t)id * 2654435761u) >> 28; }
+
+    // Retire du shard ses n meilleures transactions, dans l'ordre ; leurs ids restent en attente
+    static void takeBest(Shard& sh, size_t n, deque<Pending>& out) {
+        lock_guard<mutex> lock(sh.mtx);
+        while (n && !sh.levels.empty()) {
+            auto level = sh.levels.begin();
+            for (; n && !level->second.empty(); --n, --sh.count) {
+                out.push_back({level->second.front().tx, level->second.front().seq, level->first});
+                level->second.pop_front();
+            }
+            if (level->second.empty()) sh.levels.erase(level);
+        }
+    }
+};
+
+// Persistance : magasin de blocs et snapshots de l'état dérivé
+
+// Encodage d'un bloc complet : en-tête puis transactions (encodage canonique)
+// name(AccountId) -> const string& : permet à un exporteur de fournir ses noms déjà résolus
+template<class NameOf>
+void encodeBlock(const BlockTx& b, string& out, NameOf&& name) {
+    putLE(out,(uint32_t)b.id,4);
+    putLE(out,(uint64_t)b.timestamp,8);
+    putLE(out,b.nonce,8);
+    putStr(out,b.prevHash); putStr(out,b.merkleRoot); putStr(out,b.validator); putStr(out,b.hash);
+    const TxColumns& t=b.transactions;
+    putLE(out,t.size(),4);
+    for(size_t k=0;k<t.size();++k) encodeTx(t.ids[k],name(t.senders[k]),name(t.receivers[k]),t.amounts[k],out);
+}
+void encodeBlock(const BlockTx& b, string& out);
+
+bool decodeBlock(const string& in, size_t& pos, BlockTx& b);
+// En-tête seul (les transactions de b sont vidées) ; pos s'arrête au nombre de transactions
+bool decodeBlockHeader(const string& in, size_t& pos, BlockTx& b);
+
+// Magasin de blocs : fichier en ajout seul, un enregistrement = longueur (4 octets) + bloc encodé.
+// Un enregistrement tronqué (arrêt pendant l'écriture) est simplement ignoré à la relecture.
+class BlockStore {
+private:
+    static constexpr size_t HEADER_READ = 512; // couvre un en-tête (3 hashes, validateur court)
+    fstream file;
+    uint64_t end = 0;
+    string headerBuf;
+
+public:
+    explicit BlockStore(const string& path) {
+        file.open(path, ios::in | ios::out | ios::binary | ios::app);
+        file.seekg(0, ios::end);
+        end = (uint64_t)file.tellg();
+    }
+
+    // Renvoie l'offset de l'enregistrement
+    uint64_t append(const BlockTx& b) {
+        string rec(4, '\0');
+        encodeBlock(b, rec);
+        for (int i = 0; i < 4; ++i) rec[i] = (char)((rec.size() - 4) >> (8 * i));
+        file.clear();
+        file.seekp(0, ios::end);
+        file.write(rec.data(), rec.size());
+        file.flush();
+        uint64_t offset = end;
+        end += rec.size();
+        return offset;
+    }
+
+    bool readAt(uint64_t offset, BlockTx& b, uint64_t* next = nullptr) {
+        if (offset + 4 > end) return false;
+        char len[4];
+        file.clear();
+        file.seekg(offset);
+        if (!file.read(len, 4)) return false;
+        uint64_t n = getLE(len, 4);
+        if (offset + 4 + n > end) return false;
+        string payload(n, '\0');
+        if (!file.read(&payload[0], n)) return false;
+        size_t pos = 0;
+        if (!decodeBlock(payload, pos, b)) return false;
+        if (next) *next = offset + 4 + n;
+        return true;
+    }
+
+    // En-tête seul : lit le début de l'enregistrement et saute les transactions
+    bool readHeaderAt(uint64_t offset, BlockTx& b, uint64_t* next = nullptr) {
+        if (offset + 4 > end) return false;
+        char len[4];
+        file.clear();
+        file.seekg(offset);
+        if (!file.read(len, 4)) return false;
+        uint64_t n = getLE(len, 4);
+        if (offset + 4 + n > end) return false;
+        headerBuf.resize(min<uint64_t>(n, HEADER_READ));
+        if (!file.read(&headerBuf[0], headerBuf.size())) return false;
+        size_t pos = 0;
+        if (!decodeBlockHeader(headerBuf, pos, b)) return n > HEADER_READ && readAt(offset, b, next); // en-tête hors norme
+        if (next) *next = offset + 4 + n;
+        return true;
+    }
+
+    uint64_t size() const { return end; }
+};
+
+// Snapshot de l'état après le bloc de hauteur height :
+//   "ATSNAP" | version (4) | hauteur (8) | hash du bloc | offset du bloc dans le magasin (8)
+//   | nb comptes (4) | (nom, solde)* | nb empreintes (8) | empreintes (8)*
+//   | checksum (fastSHA256 de tout ce qui précède)
+// Les comptes sont identifiés par leur nom : les AccountId dépendent de l'ordre d'internement.
+// Les empreintes sont celles de l'index des transactions vues (stables d'une exécution à l'autre).
+struct StateSnapshot {
+    static constexpr uint32_t VERSION = 2;
+
+    uint64_t height = 0;
+    string blockHash;
+    uint64_t blockOffset = 0;
+    vector<pair<string,Amount>> balances;
+    vector<uint64_t> seen;
+
+    // Écriture dans un fichier temporaire puis renommage : un snapshot est complet ou absent
+    bool save(const string& path) const {
+        string out = "ATSNAP";
+        putLE(out, VERSION, 4);
+        putLE(out, height, 8);
+        putStr(out, blockHash);
+        putLE(out, blockOffset, 8);
+        putLE(out, balances.size(), 4);
+        for (auto& b : balances) { putStr(out, b.first); putLE(out, (uint64_t)b.second, 8); }
+        putLE(out, (uint64_t)seen.size(), 8);
+        out.reserve(out.size() + 8 * seen.size() + 64);
+        for (uint64_t d : seen) putLE(out, d, 8);
+        out += fastSHA256(out);
+        string tmp = path + ".tmp";
+        {
+            ofstream f(tmp, ios::binary | ios::trunc);
+            if (!f.write(out.data(), out.size())) return false;
+        }
+        error_code ec;
+        filesystem::rename(tmp, path, ec);
+        return !ec;
+    }
+
+    bool load(const string& path) {
+        ifstream f(path, ios::binary);
+        if (!f) return false;
+        string in((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+        if (in.size() < 6 + 4 + 64 || in.compare(0, 6, "ATSNAP") != 0) return false;
+        string body = in.substr(0, in.size() - 64);
+        if (fastSHA256(body) != in.substr(in.size() - 64)) return false;
+        size_t p = 6;
+        if (getLE(body.data() + p, 4) != VERSION || body.size() - p < 12) return false;
+        height = getLE(body.data() + p + 4, 8);
+        p += 12;
+        if (!getStr(body, p, blockHash) || body.size() - p < 12) return false;
+        blockOffset = getLE(body.data() + p, 8);
+        size_t n = getLE(body.data() + p + 8, 4);
+        p += 12;
+        balances.clear();
+        for (size_t k = 0; k < n; ++k) {
+            string name;
+            if (!getStr(body, p, name) || body.size() - p < 8) return false;
+            balances.push_back({name, (Amount)getLE(body.data() + p, 8)});
+            p += 8;
+        }
+        if (body.size() - p < 8) return false;
+        uint64_t m = getLE(body.data() + p, 8);
+        p += 8;
+        if ((body.size() - p) / 8 < m) return false;
+        seen.resize(m);
+        for (uint64_t k = 0; k < m; ++k, p += 8) seen[k] = getLE(body.data() + p, 8);
+        return true;
+    }
+};
+
+// Stockage d'une chaîne : magasin de blocs + un snapshot tous les snapshotEvery blocs.
+// Au démarrage, restore charge le dernier snapshot valide et ne rejoue que les blocs suivants :
+// le temps de démarrage dépend de la taille du snapshot, pas de la longueur de la chaîne.
+// Le snapshot porte aussi l'index des transactions vues : les rejeux de transactions antérieures
+// restent détectés sans relire les blocs, et addBlock complète l'index pendant le rejeu.
+class ChainStorage {
+private:
+    string dir;
+    BlockStore store;
+    uint64_t every;
+
+    string snapshotPath(uint64_t height) const {
+        char name[48];
+        snprintf(name, sizeof(name), "snapshot-%012llu.bin", (unsigned long long)height);
+        return (filesystem::path(dir) / name).string();
+    }
+
+    // Hauteurs des snapshots présents, de la plus récente à la plus ancienne
+    vector<uint64_t> listSnapshots() const {
+        vector<uint64_t> heights;
+        for (auto& entry : filesystem::directory_iterator(dir)) {
+            string name = entry.path().filename().string();
+            if (name.size() == 25 && name.compare(0, 9, "snapshot-") == 0 && name.compare(21, 4, ".bin") == 0)
+                heights.push_back(stoull(name.substr(9, 12)));
+        }
+        sort(heights.rbegin(), heights.rend());
+        return heights;
+    }
+
+public:
+    ChainStorage(const string& directory, uint64_t snapshotEvery = 1000)
+        : dir(directory), store((filesystem::path(directory) / "blocks.dat").string()), every(snapshotEvery) {}
+
+    // À appeler pour chaque bloc accepté par la chaîne (genesis compris), après addBlock
+    void append(const Blockchain& bc, const BlockTx& b) {
+        uint64_t offset = store.append(b);
+        if (b.id == 0 || every == 0 || b.id % every != 0) return;
+        StateSnapshot snap;
+        snap.height = b.id;
+        snap.blockHash = b.hash;
+        snap.blockOffset = offset;
+        for (AccountId a = 0; a < bc.ledger.balances.size(); ++a)
+            if (bc.ledger.balances[a] != 0) snap.balances.push_back({accounts().name(a), bc.ledger.balances[a]});
+        snap.seen = bc.seen.entries();
+        snap.save(snapshotPath(b.id));
+    }
+
+    // Reconstruit bc à partir du disque. Avec un snapshot, chain[0] est le bloc du snapshot
+    // (ancre de confiance, comme un genesis) ; sinon tout le magasin est rejoué.
+    bool restore(Blockchain& bc, bool useSnapshots = true) {
+        bc.chain.clear();
+        bc.ledger = Ledger();
+        bc.seen.clear();
+        uint64_t offset = 0, next = 0;
+        BlockTx b;
+        if (useSnapshots) {
+            for (uint64_t h : listSnapshots()) {
+                StateSnapshot snap;
+                if (!snap.load(snapshotPath(h)) || snap.height != h) continue;
+                if (!store.readAt(snap.blockOffset, b, &next) || b.hash != snap.blockHash || (uint64_t)b.id != h) continue;
+                for (auto& entry : snap.balances) bc.ledger.credit(accounts().intern(entry.first), entry.second);
+                bc.seen.insert(snap.seen.data(), snap.seen.size());
+                bc.anchor(b);
+                offset = next;
+                break;
+            }
+        }
+        while (store.readAt(offset, b, &next)) {
+            if (bc.chain.empty()) {
+                for (size_t k = 0; k < b.transactions.size(); ++k) bc.ledger.credit(b.transactions.receivers[k], b.transactions.amounts[k]);
+                bc.seen.insertBlock(b.transactions);
+                bc.anchor(b);
+            } else if (b.prevHash != bc.chain.back().hash || !bc.addBlock(b)) {
+                break;
+            }
+            offset = next;
+        }
+        return !bc.chain.empty();
+    }
+};
+
+// Chaîne légère : en-têtes seuls, de taille fixe (96 octets), rangés de façon contiguë. Les hashes
+// y sont binaires (HashWords) et le validateur est un indice dans une table de noms ; le hash d'un
+// bloc est le prevHash du suivant, seul celui de la pointe est gardé à part. Chaînage et hash sont
+// vérifiés à l'ajout, la règle de consensus par verifyHeaders, sans aucune transaction. Les corps
+// restent dans le magasin de blocs : fetchBody les relit et les vérifie contre la racine Merkle.
+class LightChain {
+public:
+    struct Header {
+        HashWords prevHash, merkleRoot;
+        int64_t timestamp;
+        uint64_t nonce;
+        uint64_t bodyOffset;   // enregistrement du bloc dans le magasin
+        uint32_t validator;    // indice dans validatorNames (0 : aucun)
+        uint32_t reserved;
+    };
+
+    explicit LightChain(BlockStore& s) : store(s), validatorNames{""}, validatorIds{{"", 0}} {}
+
+    size_t size() const { return headers.size(); }
+    int height() const { return first + (int)headers.size() - 1; }
+    uint64_t bodyOffset(size_t i) const { return headers[i].bodyOffset; }
+    size_t memoryBytes() const { size_t n = headers.capacity() * sizeof(Header); for (auto& v : validatorNames) n += sizeof(string) + v.capacity(); return n; }
+
+    // Ajoute l'en-tête de b (corps à bodyOffset dans le magasin). Refusé si le hash ne correspond
+    // pas à l'en-tête, si b ne prolonge pas la pointe ou si un hash n'est pas hexadécimal.
+    bool append(const BlockTx& b, uint64_t bodyOffset) {
+        Header h{};
+        HashWords hash;
+        if (!parseHex(b.prevHash, h.prevHash) || !parseHex(b.merkleRoot, h.merkleRoot) || !parseHex(b.hash, hash) || !b.hashMatches()) return false;
+        if (!headers.empty() && (b.id != height() + 1 || !same(h.prevHash, tip))) return false;
+        if (headers.empty()) first = b.id;
+        h.timestamp = (int64_t)b.timestamp;
+        h.nonce = b.nonce;
+        h.bodyOffset = bodyOffset;
+        h.validator = internValidator(b.validator);
+        headers.push_back(h);
+        tip = hash;
+        return true;
+    }
+
+    // Synchronisation rapide : en-têtes lus dans le magasin à partir d'offset, transactions
+    // sautées ; arrêt au premier bloc refusé. Renvoie le nombre d'en-têtes ajoutés.
+    size_t sync(uint64_t offset = 0) {
+        BlockTx b;
+        uint64_t next = 0;
+        size_t added = 0;
+        while (store.readHeaderAt(offset, b, &next) && append(b, offset)) { offset = next; ++added; }
+        return added;
+    }
+
+    // En-tête i reconstitué dans b (transactions vides ; chaînes réutilisées d'un appel à l'autre)
+    void headerAt(size_t i, BlockTx& b) const {
+        const Header& h = headers[i];
+        b.id = first + (int)i;
+        b.timestamp = (time_t)h.timestamp;
+        b.nonce = h.nonce;
+        hex(h.prevHash, b.prevHash);
+        hex(h.merkleRoot, b.merkleRoot);
+        hex(hashWords(i), b.hash);
+        b.validator = validatorNames[h.validator];
+        if (b.transactions.size()) b.transactions = TxColumns();
+    }
+    string hashAt(size_t i) const { string s; hex(hashWords(i), s); return s; }
+
+    // Règle du consensus vérifiée sur les en-têtes seuls (le premier est l'ancre de confiance) ;
+    // renvoie l'indice du premier en-tête refusé, size() si tous sont valides
+    template<class Consensus>
+    size_t verifyHeaders(const Consensus& consensus) const {
+        TraceSpan span("vérification en-têtes", "validation", (int64_t)headers.size());
+        BlockTx b;
+        for (size_t i = 0; i < headers.size(); ++i) {
+            headerAt(i, b);
+            if (!b.hashMatches() || (i > 0 && !consensus.verify(b))) return i;
+        }
+        return headers.size();
+    }
+
+    // Corps du bloc i relu dans le magasin, sous l'en-tête de la chaîne légère ; false s'il est
+    // illisible, d'une autre hauteur, ou si ses transactions ne redonnent pas la racine Merkle
+    bool fetchBody(size_t i, BlockTx& b) {
+        if (i >= headers.size() || !store.readAt(headers[i].bodyOffset, b) || b.id != first + (int)i) return false;
+        HashWords root;
+        if (!parseHex(computeTxMerkleRoot(b.transactions), root) || !same(root, headers[i].merkleRoot)) return false;
+        TxColumns txs = std::move(b.transactions);
+        headerAt(i, b);
+        b.transactions = std::move(txs);
+        return true;
+    }
+
+private:
+    BlockStore& store;
+    vector<Header> headers;
+    HashWords tip{};
+    int first = 0;
+    vector<string> validatorNames;
+    unordered_map<string, uint32_t> validatorIds;
+
+    static bool same(const HashWords& a, const HashWords& b) { return memcmp(a.w, b.w, sizeof a.w) == 0; }
+    static void hex(const HashWords& h, string& out) { out.resize(64); writeHex(h, &out[0]); }
+    const HashWords& hashWords(size_t i) const { return i + 1 < headers.size() ? headers[i + 1].prevHash : tip; }
+    uint32_t internValidator(const string& name) {
+        auto it = validatorIds.find(name);
+        if (it != validatorIds.end()) return it->second;
+        validatorNames.push_back(name);
+        return validatorIds[name] = (uint32_t)validatorNames.size() - 1;
+    }
+};
+
+// Index des adresses, tenu à jour bloc par bloc (append après addBlock, comme ChainStorage) :
+//   - postings : pour chaque compte, ses apparitions (hauteur, indice de transaction) dans l'ordre
+//     de la chaîne, avec le solde net du compte après chacune : historique paginé et solde à une
+//     hauteur donnée par recherche dichotomique, solde courant en O(1) ;
+//   - filtre de Bloom par bloc (comptes touchés, ~1 % de faux positifs) : un parcours des corps
+//     (magasin, chaîne légère) ne lit que les blocs candidats.
+// Soldes nets comme computeBalances : chaque transaction débite l'émetteur et crédite le destinataire,
+// sauf l'émetteur du genesis, dont la dette envers tous les comptes ne tiendrait pas dans un Amount.
+class AddressIndex {
+public:
+    struct Posting { uint32_t height; uint32_t tx; Amount balanceAfter; };
+
+    AddressIndex() : issuer(Blockchain::issuer()) {}
+    explicit AddressIndex(const Blockchain& bc) : AddressIndex() { for (const auto& b : bc.chain.snapshot()) append(b); }
+
+    // Blocs ajoutés par hauteurs croissantes ; false (bloc ignoré) sinon
+    bool append(const BlockTx& b) {
+        uint32_t h = (uint32_t)b.id;
+        if (!bloomStart.empty() && h != first + blocks()) return false;
+        if (bloomStart.empty()) first = h;
+        TraceSpan span("indexation bloc", "index", b.id);
+        const TxColumns& t = b.transactions;
+        if (byAccount.size() < accounts().size()) { byAccount.resize(accounts().size()); balances.resize(accounts().size(), 0); }
+
+        size_t words = bloomWordsFor(t.size());
+        bloomStart.push_back(bloomBits.size());
+        bloomBits.resize(bloomBits.size() + words, 0);
+        uint64_t* bits = bloomBits.data() + bloomStart.back();
+        for (size_t k = 0; k < t.size(); ++k) {
+            AccountId s = t.senders[k], r = t.receivers[k];
+            if (s != issuer) balances[s] -= t.amounts[k];
+            balances[r] += t.amounts[k];
+            byAccount[s].push_back({h, (uint32_t)k, balances[s]});
+            if (r != s) byAccount[r].push_back({h, (uint32_t)k, balances[r]});
+            bloomAdd(bits, words, s);
+            bloomAdd(bits, words, r);
+        }
+        txs += t.size();
+        return true;
+    }
+
+    size_t blocks() const { return bloomStart.size(); }
+    uint64_t transactions() const { return txs; }
+    Amount balance(AccountId a) const { return a < balances.size() ? balances[a] : 0; }
+
+    // Solde net après le bloc de hauteur height (postings dont la hauteur est <= height)
+    Amount balanceAt(AccountId a, uint32_t height) const {
+        const vector<Posting>& p = postings(a);
+        auto it = upper_bound(p.begin(), p.end(), height, [](uint32_t h, const Posting& x) { return h < x.height; });
+        return it == p.begin() ? 0 : prev(it)->balanceAfter;
+    }
+
+    const vector<Posting>& postings(AccountId a) const { static const vector<Posting> none; return a < byAccount.size() ? byAccount[a] : none; }
+
+    // Page d'historique : au plus limit postings à partir de la hauteur from
+    pair<const Posting*, const Posting*> history(AccountId a, uint32_t from, size_t limit) const {
+        const vector<Posting>& p = postings(a);
+        auto it = lower_bound(p.begin(), p.end(), from, [](const Posting& x, uint32_t h) { return x.height < h; });
+        const Posting* begin = p.data() + (it - p.begin());
+        return {begin, begin + min(limit, (size_t)(p.end() - it))};
+    }
+
+    // Hauteurs distinctes des blocs où le compte apparaît
+    vector<uint32_t> blocksOf(AccountId a) const {
+        vector<uint32_t> out;
+        for (const Posting& p : postings(a)) if (out.empty() || out.back() != p.height) out.push_back(p.height);
+        return out;
+    }
+
+    // Filtre du bloc de hauteur height : false garantit que le compte n'y figure pas
+    bool mayContain(uint32_t height, AccountId a) const {
+        if (height < first || height - first >= blocks()) return false;
+        size_t i = height - first, begin = bloomStart[i], end = i + 1 < blocks() ? bloomStart[i + 1] : bloomBits.size();
+        return bloomTest(bloomBits.data() + begin, end - begin, a);
+    }
+
+    size_t memoryBytes() const {
+        size_t n = bloomBits.capacity() * 8 + bloomStart.capacity() * sizeof(size_t) + balances.capacity() * sizeof(Amount);
+        for (auto& p : byAccount) n += sizeof(p) + p.capacity() * sizeof(Posting);
+        return n;
+    }
+
+private:
+    static constexpr int BLOOM_HASHES = 5;
+    uint32_t first = 0;
+    uint64_t txs = 0;
+    AccountId issuer;
+    vector<vector<Posting>> byAccount;
+    vector<Amount> balances;
+    vector<uint64_t> bloomBits;   // filtres de tous les blocs, bout à bout
+    vector<size_t> bloomStart;    // début (en mots) du filtre de chaque bloc
+
+    // ~8 à 16 bits par compte (au plus deux comptes par transaction), taille en puissance de deux
+    static size_t bloomWordsFor(size_t nTxs) {
+        size_t bits = 64;
+        while (bits < 16 * nTxs) bits <<= 1;
+        return bits / 64;
+    }
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33; x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ULL;
+        return x ^ (x >> 33);
+    }
+    // Double hachage : sondes h1 + i*h2 (h2 impair) modulo la taille du filtre
+    static void bloomAdd(uint64_t* bits, size_t words, AccountId a) {
+        uint64_t h = mix(a + 1), h1 = h, h2 = (h >> 32) | 1, mask = words * 64 - 1;
+        for (int i = 0; i < BLOOM_HASHES; ++i, h1 += h2) bits[(h1 & mask) >> 6] |= 1ULL << (h1 & 63);
+    }
+    static bool bloomTest(const uint64_t* bits, size_t words, AccountId a) {
+        uint64_t h = mix(a + 1), h1 = h, h2 = (h >> 32) | 1, mask = words * 64 - 1;
+        for (int i = 0; i < BLOOM_HASHES; ++i, h1 += h2) if (!(bits[(h1 & mask) >> 6] & (1ULL << (h1 & 63)))) return false;
+        return true;
+    }
+};
+
+// Sortie tamponnée : les écritures s'accumulent dans un grand tampon (1 Mio par défaut) vidé par
+// gros morceaux avec fwrite, sans flux C++ ni allocation par champ. Fichier ou stdout.
+class OutputSink {
+public:
+    explicit OutputSink(FILE* f, size_t capacity = 1 << 20) : file(f), owned(false), buf(capacity) {}
+    explicit OutputSink(const string& path, size_t capacity = 1 << 20) : file(fopen(path.c_str(), "wb")), owned(true), buf(capacity) {
+        if (!file) throw runtime_error("impossible d'ouvrir " + path);
+    }
+    ~OutputSink() { flush(); if (owned) fclose(file); }
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    void write(const char* p, size_t n) {
+        if (n > buf.size() - used) {
+            flush();
+            if (n >= buf.size()) { failed |= fwrite(p, 1, n, file) != n; bytes += n; return; }
+        }
+        memcpy(buf.data() + used, p, n);
+        used += n; bytes += n;
+    }
+    void write(const string& str) { write(str.data(), str.size()); }
+    void put(char c) { if (used == buf.size()) flush(); buf[used++] = c; ++bytes; }
+
+    // Formatage sur place : reserve(n) garantit n octets contigus (n <= capacité), commit(fin) les valide
+    char* reserve(size_t n) { if (n > buf.size() - used) flush(); return buf.data() + used; }
+    void commit(char* end) { size_t n = end - (buf.data() + used); used += n; bytes += n; }
+
+    void flush() {
+        if (used) { failed |= fwrite(buf.data(), 1, used, file) != used; used = 0; }
+        fflush(file);
+    }
+    bool ok() const { return !failed; }
+    uint64_t written() const { return bytes; }
+
+private:
+    FILE* file;
+    bool owned;
+    vector<char> buf;
+    size_t used = 0;
+    uint64_t bytes = 0;
+    bool failed = false;
+};
+
+// Export de la chaîne, un bloc à la fois :
+//   JSONL   : un objet JSON par ligne, transactions comprises (montants en décimal exact)
+//   BINAIRE : enregistrements du magasin de blocs (longueur + bloc encodé), relisibles par BlockStore
+class ChainExporter {
+public:
+    enum Format { JSONL, BINARY };
+
+    ChainExporter(OutputSink& s, Format f) : sink(s), format(f) {}
+
+    void write(const BlockTx& b) { if (format == JSONL) writeJson(b); else writeBinary(b); ++count; }
+    void write(const Blockchain& bc) { for (const auto& b : bc.chain.snapshot()) write(b); }
+    size_t blocks() const { return count; }
+
+private:
+    OutputSink& sink;
+    Format format;
+    size_t count = 0;
+    string scratch;
+    vector<const string*> names; // noms déjà résolus (la table des comptes ne déplace jamais un nom)
+
+    const string& name(AccountId id) {
+        if (id >= names.size()) names.resize(id + 1, nullptr);
+        if (!names[id]) names[id] = &accounts().name(id);
+        return *names[id];
+    }
+
+    template<class Int>
+    void number(Int v) { char* p = sink.reserve(24); sink.commit(to_chars(p, p + 24, v).ptr); }
+    void literal(const char* text) { sink.write(text, strlen(text)); }
+    void jsonString(const string& v) {
+        sink.put('"');
+        size_t start = 0;
+        for (size_t i = 0; i < v.size(); ++i) {
+            unsigned char c = v[i];
+            if (c != '"' && c != '\\' && c >= 0x20) continue;
+            sink.write(v.data() + start, i - start);
+            char esc[8];
+            int n = (c == '"' || c == '\\') ? snprintf(esc, sizeof esc, "\\%c", c) : snprintf(esc, sizeof esc, "\\u%04x", c);
+            sink.write(esc, n);
+            start = i + 1;
+        }
+        sink.write(v.data() + start, v.size() - start);
+        sink.put('"');
+    }
+
+    void writeJson(const BlockTx& b) {
+        literal("{\"id\":"); number(b.id);
+        literal(",\"timestamp\":"); number((long long)b.timestamp);
+        literal(",\"prevHash\":"); jsonString(b.prevHash);
+        literal(",\"merkleRoot\":"); jsonString(b.merkleRoot);
+        literal(",\"nonce\":"); number(b.nonce);
+        literal(",\"validator\":"); jsonString(b.validator);
+        literal(",\"hash\":"); jsonString(b.hash);
+        literal(",\"txs\":[");
+        const TxColumns& t = b.transactions;
+        for (size_t k = 0; k < t.size(); ++k) {
+            literal(k ? ",{\"id\":" : "{\"id\":"); number(t.ids[k]);
+            literal(",\"from\":"); jsonString(name(t.senders[k]));
+            literal(",\"to\":"); jsonString(name(t.receivers[k]));
+            literal(",\"amount\":");
+            char* p = sink.reserve(32);
+            sink.commit(formatAmount(p, p + 32, t.amounts[k]));
+            sink.put('}');
+        }
+        literal("]}\n");
+    }
+
+    void writeBinary(const BlockTx& b) {
+        scratch.assign(4, '\0');
+        encodeBlock(b, scratch, [this](AccountId id) -> const string& { return name(id); });
+        for (int i = 0; i < 4; ++i) scratch[i] = (char)((scratch.size() - 4) >> (8 * i));
+        sink.write(scratch);
+    }
+};
+
+// Mode silencieux : pas d'affichage bloc par bloc pendant les sections chronométrées,
+// les blocs sont affichés (ou exportés) une fois les mesures terminées
+bool& quietMode();
+
+// Générateur déterministe et portable (SplitMix64) : même graine, même suite sur toutes les
+// plateformes, contrairement à rand() ou aux distributions de la bibliothèque standard.
+class SplitMix64 {
+private:
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Entier uniforme dans [0,bound) : on rejette les 2^64 mod bound plus petites valeurs
+    uint64_t below(uint64_t bound) {
+        uint64_t threshold = (0 - bound) % bound;
+        for (;;) { uint64_t x = next(); if (x >= threshold) return x % bound; }
+    }
+
+    // Réel uniforme dans [0,1) (53 bits)
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+};
+
+// Graine de sélection du validateur d'un créneau, dérivée de l'état de la chaîne
+// (premier mot de fastSHA256(prevHash:slot), soit ses 16 premiers chiffres hexadécimaux)
+string selectionPreimage(const string& prevHash, uint64_t slot);
+uint64_t selectionSeed(const string& prevHash, uint64_t slot);
+
+// Loi de Zipf sur les rangs 1..n (P(k) ∝ 1/k^s) par rejet-inversion (Hörmann et Derflinger) :
+// O(1) en mémoire et en temps moyen quel que soit n, sans table de probabilités.
+class ZipfSampler {
+public:
+    ZipfSampler(uint64_t count, double exponent) : n(count), s(exponent) {
+        if (n == 0) throw invalid_argument("ZipfSampler : n doit être positif");
+        if (s < 0) throw invalid_argument("ZipfSampler : exposant négatif");
+        hIntegralX1 = hIntegral(1.5) - 1;
+        hIntegralN = hIntegral(n + 0.5);
+        sCut = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+    }
+
+    // Rang dans [1,n] (1 = le plus fréquent)
+    uint64_t sample(SplitMix64& rng) const {
+        if (s == 0) return 1 + rng.below(n);
+        for (;;) {
+            double u = hIntegralN + rng.uniform() * (hIntegralX1 - hIntegralN);
+            double x = hIntegralInverse(u);
+            uint64_t k = (uint64_t)max(1.0, min((double)n, floor(x + 0.5)));
+            if (k - x <= sCut || u >= hIntegral(k + 0.5) - h((double)k)) return k;
+        }
+    }
+
+private:
+    uint64_t n;
+    double s, hIntegralX1, hIntegralN, sCut;
+
+    double h(double x) const { return exp(-s * log(x)); }
+    double hIntegral(double x) const { double lx = log(x); return helper2((1 - s) * lx) * lx; }
+    double hIntegralInverse(double x) const { double t = max(-1.0, x * (1 - s)); return exp(helper1(t) * x); }
+    // log1p(x)/x et expm1(x)/x, prolongés par continuité en 0
+    static double helper1(double x) { return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x)); }
+    static double helper2(double x) { return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x)); }
+};
+
+// Charge synthétique reproductible : flux de transactions entre `accounts` comptes, émetteurs et
+// destinataires tirés selon deux lois de Zipf (les comptes les plus actifs en envoi et en réception
+// diffèrent : permutation des destinataires), montants log-normaux bornés. Les transactions sont
+// produites à la demande, sans matérialiser le flux ; même graine, même flux.
+struct WorkloadConfig {
+    size_t accounts = 10000;
+    double senderSkew = 1.1;      // exposant de Zipf (0 = uniforme)
+    double receiverSkew = 0.8;
+    double amountMedian = 10;     // unités
+    double amountSigma = 1.0;     // écart type du logarithme
+    double minAmount = 0.01, maxAmount = 10000;
+    double initialBalance = 0;    // crédit de genèse par compte (0 : le plus grand dont le total tient dans un Amount)
+    uint64_t seed = 1;
+};
+
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& c)
+        : cfg(c), rng(c.seed), senders(c.accounts, c.senderSkew), receivers(c.accounts, c.receiverSkew) {
+        if (cfg.accounts < 2) throw invalid_argument("WorkloadGenerator : au moins deux comptes");
+        // Total émis au genesis représentable : aucun solde ne peut alors déborder
+        Amount cap = numeric_limits<Amount>::max() / (Amount)cfg.accounts;
+        if (cfg.initialBalance == 0) cfg.initialBalance = (double)(cap / AMOUNT_SCALE);
+        else if (!(cfg.initialBalance > 0) || cfg.initialBalance * AMOUNT_SCALE > (double)cap || toAmount(cfg.initialBalance) > cap)
+            throw overflow_error("WorkloadGenerator : crédits de genèse hors de la plage d'un Amount");
+        ids.reserve(cfg.accounts);
+        for (size_t a = 0; a < cfg.accounts; ++a) ids.push_back(accounts().intern(accountName(a)));
+        receiverRank.resize(cfg.accounts);
+        for (size_t a = 0; a < cfg.accounts; ++a) receiverRank[a] = (uint32_t)a;
+        for (size_t a = cfg.accounts - 1; a > 0; --a) swap(receiverRank[a], receiverRank[rng.below(a + 1)]);
+    }
+
+    static string accountName(size_t a) { return "compte" + to_string(a); }
+    AccountId account(size_t a) const { return ids[a]; }
+
+    // Allocations de genèse couvrant tous les comptes du flux
+    vector<pair<string,double>> genesisAllocations() const {
+        vector<pair<string,double>> alloc;
+        alloc.reserve(cfg.accounts);
+        for (size_t a = 0; a < cfg.accounts; ++a) alloc.push_back({accountName(a), cfg.initialBalance});
+        return alloc;
+    }
+
+    Transaction next() {
+        size_t from = senders.sample(rng) - 1;
+        size_t to = receiverRank[receivers.sample(rng) - 1];
+        if (to == from) to = (to + 1) % cfg.accounts;
+        double amount = cfg.amountMedian * exp(cfg.amountSigma * gaussian());
+        amount = min(cfg.maxAmount, max(cfg.minAmount, amount));
+        return Transaction((int)++produced, ids[from], ids[to], toAmount(amount));
+    }
+    // Frais par paliers (comme les niveaux proposés par un portefeuille), plus élevés pour les gros
+    // montants : peu de niveaux distincts, donc peu de files dans le mempool
+    Amount feeFor(const Transaction& tx) {
+        Amount tier = 1 + (Amount)rng.below(8) + (tx.amount >= toAmount(cfg.amountMedian) ? 8 : 0);
+        return tier * toAmount(0.0001);
+    }
+
+    // Branchements directs : un bloc de colonnes, le mempool, ou une feuille Merkle à la fois
+    void fill(TxColumns& out, size_t count) { out.reserve(out.size() + count); for (size_t i = 0; i < count; ++i) out.push(next()); }
+    void feed(Mempool& mempool, size_t count) { for (size_t i = 0; i < count; ++i) { Transaction tx = next(); mempool.submit(tx, feeFor(tx)); } }
+
+    uint64_t generated() const { return produced; }
+
+private:
+    WorkloadConfig cfg;
+    SplitMix64 rng;
+    ZipfSampler senders, receivers;
+    vector<AccountId> ids;
+    vector<uint32_t> receiverRank;
+    uint64_t produced = 0;
+    double spare = 0;
+    bool hasSpare = false;
+
+    // Loi normale centrée réduite (Box-Muller, la seconde valeur est gardée pour l'appel suivant)
+    double gaussian() {
+        if (hasSpare) { hasSpare = false; return spare; }
+        double u = 1 - rng.uniform(), v = rng.uniform();
+        const double TWO_PI = 6.283185307179586;
+        double r = sqrt(-2 * log(u));
+        spare = r * sin(TWO_PI * v); hasSpare = true;
+        return r * cos(TWO_PI * v);
+    }
+};
+
+// Tirage pondéré en O(1) par la méthode des alias de Walker, en arithmétique entière exacte :
+// chaque colonne a une capacité égale au poids total T, un tirage choisit une colonne
+// uniformément puis un seuil uniforme dans [0,T). Aucun biais de modulo ni d'arrondi.
+// La construction est en O(n) et n'est refaite que lorsque les poids changent.
+class AliasSampler {
+private:
+    vector<uint64_t> prob;   // seuil d'acceptation de la colonne, dans [0,T]
+    vector<uint32_t> alias;  // indice retenu si le seuil n'est pas atteint
+    uint64_t totalWeight = 0;
+
+public:
+    void build(const vector<uint64_t>& weights) {
+        size_t n = weights.size();
+        unsigned __int128 total = 0;
+        for (uint64_t w : weights) total += w;
+        if (n == 0 || total == 0) throw invalid_argument("AliasSampler : poids total nul");
+        if (total > UINT64_MAX) throw overflow_error("AliasSampler : poids total > 2^64-1");
+        totalWeight = (uint64_t)total;
+
+        // Poids mis à l'échelle : somme = n * T, soit exactement n colonnes pleines
+        vector<unsigned __int128> scaled(n);
+        vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = (unsigned __int128)weights[i] * n;
+            (scaled[i] < totalWeight ? small : large).push_back((uint32_t)i);
+        }
+        prob.assign(n, totalWeight);
+        alias.resize(n);
+        for (size_t i = 0; i < n; ++i) alias[i] = (uint32_t)i;
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(); small.pop_back();
+            uint32_t l = large.back();
+            prob[s] = (uint64_t)scaled[s];
+            alias[s] = l;
+            scaled[l] -= totalWeight - scaled[s];
+            if (scaled[l] < totalWeight) { large.pop_back(); small.push_back(l); }
+        }
+        // Les colonnes restantes sont pleines (seuil = T)
+    }
+
+    // Générateur portable et réduction d'intervalle explicite (below) : même tirage sur toute
+    // bibliothèque standard, donc reproductible par tout nœud
+    size_t sample(SplitMix64& r) const {
+        size_t column = r.below(prob.size());
+        uint64_t y = r.below(totalWeight);
+        return y < prob[column] ? column : alias[column];
+    }
+
+    size_t size() const { return prob.size(); }
+    uint64_t total() const { return totalWeight; }
+    // Colonne c : seuil et alias (contrôle exact de la masse attribuée à chaque indice)
+    uint64_t threshold(size_t c) const { return prob[c]; }
+    size_t aliasOf(size_t c) const { return alias[c]; }
+};
+
+// Registre de stakes dynamique : arbre de Fenwick sur les stakes, indexé par emplacement.
+// Ajout, retrait et mise à jour en O(log n), tirage pondéré en O(log n) par descente dans l'arbre.
+// Convient quand l'ensemble change entre presque chaque tirage (dépôts, retraits, slashing),
+// là où la table d'alias devrait être reconstruite en O(n).
+class StakeRegistry {
+private:
+    vector<uint64_t> tree;      // Fenwick, indices 1..capacity
+    vector<uint64_t> stakes;    // par emplacement
+    vector<string> names;       // par emplacement ("" = libre)
+    unordered_map<string,size_t> slots;
+    vector<size_t> freeSlots;
+    uint64_t totalStake = 0;
+
+    // Les sommes sont modulo 2^64 : ajouter (nouveau - ancien) suffit aussi pour une baisse
+    void add(size_t slot, uint64_t delta) { for (size_t i = slot + 1; i < tree.size(); i += i & (0 - i)) tree[i] += delta; }
+
+    void grow() {
+        size_t cap = max<size_t>(16, 2 * stakes.size());
+        stakes.resize(cap, 0);
+        names.resize(cap);
+        tree.assign(cap + 1, 0);
+        for (size_t i = 1; i <= cap; ++i) {
+            tree[i] += stakes[i - 1];
+            size_t parent = i + (i & (0 - i));
+            if (parent <= cap) tree[parent] += tree[i];
+        }
+    }
+
+public:
+    // Ajoute le validateur ou met à jour son stake ; un stake nul le retire
+    void setStake(const string& name, uint64_t stake) {
+        auto it = slots.find(name);
+        uint64_t old = it == slots.end() ? 0 : stakes[it->second];
+        if (stake > old && stake - old > UINT64_MAX - totalStake) throw overflow_error("StakeRegistry : stake total > 2^64-1");
+        if (stake == 0) { remove(name); return; }
+        size_t slot;
+        if (it != slots.end()) slot = it->second;
+        else {
+            if (freeSlots.empty()) {
+                size_t used = slots.size();
+                if (used == stakes.size()) grow();
+                for (size_t i = stakes.size(); i-- > used;) freeSlots.push_back(i);
+            }
+            slot = freeSlots.back(); freeSlots.pop_back();
+            names[slot] = name;
+            slots.emplace(name, slot);
+        }
+        add(slot, stake - old);
+        totalStake += stake - old;
+        stakes[slot] = stake;
+    }
+
+    bool remove(const string& name) {
+        auto it = slots.find(name);
+        if (it == slots.end()) return false;
+        size_t slot = it->second;
+        add(slot, 0 - stakes[slot]);
+        totalStake -= stakes[slot];
+        stakes[slot] = 0;
+        names[slot].clear();
+        freeSlots.push_back(slot);
+        slots.erase(it);
+        return true;
+    }
+
+    uint64_t stakeOf(const string& name) const { auto it = slots.find(name); return it == slots.end() ? 0 : stakes[it->second]; }
+    uint64_t total() const { return totalStake; }
+    size_t size() const { return slots.size(); }
+
+    // Validateur dont l'intervalle de stake cumulé contient point (0 <= point < total())
+    const string& sampleAt(uint64_t point) const {
+        size_t pos = 0, step = 1;
+        while (step * 2 < tree.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree.size() && tree[pos + step] <= point) { pos += step; point -= tree[pos]; }
+        }
+        return names[pos];
+    }
+
+    // Tirage portable (SplitMix64, réduction sans biais), comme AliasSampler::sample
+    const string& sample(SplitMix64& r) const {
+        if (totalStake == 0) throw invalid_argument("StakeRegistry : aucun stake");
+        return sampleAt(r.below(totalStake));
+    }
+
+    // Validateurs et stakes, dans l'ordre des emplacements
+    vector<pair<string,uint64_t>> entries() const {
+        vector<pair<string,uint64_t>> out;
+        out.reserve(slots.size());
+        for (size_t i = 0; i < names.size(); ++i) if (!names[i].empty()) out.push_back({names[i], stakes[i]});
+        return out;
+    }
+};
+
+// Système PoS : les stakes vivent dans un StakeRegistry, l'ensemble des validateurs évolue donc
+// en O(log n) par dépôt, retrait ou slashing, sans reconstruction. Deux systèmes ayant subi la
+// même suite d'opérations tirent les mêmes validateurs.
+class PoSSystem {
+public:
+    PoSSystem() : PoSSystem({{"Alice",50},{"Bob",30},{"Charlie",20}}) {}
+    explicit PoSSystem(const vector<pair<string,uint64_t>>& v){ for(auto& e:v) registry.setStake(e.first,e.second); }
+
+    void deposit(const string& name, uint64_t amount){
+        uint64_t st=registry.stakeOf(name);
+        if(amount>UINT64_MAX-st) throw overflow_error("PoSSystem : stake > 2^64-1");
+        registry.setStake(name,st+amount);
+    }
+    // false (rien n'est retiré) si le stake est insuffisant ; un stake ramené à 0 quitte l'ensemble
+    bool withdraw(const string& name, uint64_t amount){
+        uint64_t st=registry.stakeOf(name);
+        if(amount>st) return false;
+        registry.setStake(name,st-amount);
+        return true;
+    }
+    // Confisque permille/1000 du stake (arrondi inférieur) ; renvoie le montant confisqué
+    uint64_t slash(const string& name, uint32_t permille){
+        uint64_t st=registry.stakeOf(name);
+        uint64_t cut=(uint64_t)((unsigned __int128)st*min<uint32_t>(permille,1000)/1000);
+        registry.setStake(name,st-cut);
+        return cut;
+    }
+    uint64_t stakeOf(const string& name) const { return registry.stakeOf(name); }
+    uint64_t totalStake() const { return registry.total(); }
+    size_t size() const { return registry.size(); }
+    vector<pair<string,uint64_t>> validators() const { return registry.entries(); }
+    const StakeRegistry& stakes() const { return registry; }
+
+    // Sélection déterministe : graine tirée du hash du bloc précédent et du créneau (hauteur),
+    // donc reproductible, sans état partagé et recalculable par tout nœud lors de la validation
+    string chooseValidator(const string& prevHash, uint64_t slot) const { return validatorForSeed(selectionSeed(prevHash,slot)); }
+    const string& validatorForSeed(uint64_t seed) const { SplitMix64 r(seed); return registry.sample(r); }
+
+    // Un bloc sans validateur est un bloc PoW : rien à vérifier ici
+    bool verifyValidator(const BlockTx& b) const { return b.validator.empty() || b.validator==chooseValidator(b.prevHash,b.id); }
+
+    // Vérification en masse, répartie sur plusieurs threads : indices des blocs au validateur incorrect
+    // blocks : vector<BlockTx> ou ConcurrentChain::Snapshot (taille figée pendant la vérification)
+    template<class Blocks>
+    vector<size_t> verifyValidators(const Blocks& blocks, unsigned threads = 0) const {
+        if(threads==0) threads=max(1u,thread::hardware_concurrency());
+        if(blocks.size()<1024) threads=1;
+        vector<char> bad(blocks.size(),0);
+        auto worker=[&](unsigned t){ if(t) Tracer::nameThread("validateurs"); TraceSpan span("vérification validateurs","pos"); for(size_t i=blocks.size()*t/threads;i<blocks.size()*(t+1)/threads;++i) bad[i]=!verifyValidator(blocks[i]); };
+        vector<thread> pool;
+        for(unsigned t=1;t<threads;++t) pool.emplace_back(worker,t);
+        worker(0);
+        for(auto& th:pool) th.join();
+        vector<size_t> invalid;
+        for(size_t i=0;i<blocks.size();++i) if(bad[i]) invalid.push_back(i);
+        return invalid;
+    }
+
+
+private:
+    StakeRegistry registry;
+};
+
+// Historique des stakes : chaque époque fixe la table des validateurs à partir d'une hauteur.
+// Les tables sont immuables et partagées, une vérification lit donc le stake en vigueur à la
+// hauteur du bloc sans copie ni verrou.
+class StakeHistory {
+public:
+    void set(uint64_t fromHeight, vector<pair<string,uint64_t>> stakes) {
+        auto table = make_shared<const PoSSystem>(std::move(stakes));
+        auto it = lower_bound(epochs.begin(), epochs.end(), fromHeight, [](const Epoch& e, uint64_t h) { return e.from < h; });
+        if (it != epochs.end() && it->from == fromHeight) it->table = table;
+        else epochs.insert(it, {fromHeight, table});
+    }
+    // Table en vigueur à la hauteur h (nullptr avant la première époque)
+    const PoSSystem* at(uint64_t h) const { size_t e = epochIndex(h); return e == SIZE_MAX ? nullptr : epochs[e].table.get(); }
+    size_t epochIndex(uint64_t h) const {
+        auto it = upper_bound(epochs.begin(), epochs.end(), h, [](uint64_t x, const Epoch& e) { return x < e.from; });
+        return it == epochs.begin() ? SIZE_MAX : size_t(it - epochs.begin()) - 1;
+    }
+    size_t size() const { return epochs.size(); }
+
+private:
+    friend struct BatchVerifier;
+    struct Epoch { uint64_t from; shared_ptr<const PoSSystem> table; };
+    vector<Epoch> epochs;
+};
+
+struct BatchVerifyResult {
+    vector<size_t> badLink, badHash, badValidator; // indices dans la chaîne
+    bool ok() const { return badLink.empty() && badHash.empty() && badValidator.empty(); }
+};
+
+// Vérification par lots de blocs PoS [first, last) : chaînage, recalcul du hash et éligibilité
+// du validateur au stake en vigueur. Les préimages d'un lot sont écrites dans des tampons
+// réutilisés puis hachées ensemble (fastHashBatch) ; l'époque de stake avance avec la hauteur
+// au lieu d'une recherche par bloc. La plage est découpée entre les threads.
+// blocks : vector<BlockTx> ou ConcurrentChain::Snapshot (accès par indice, taille figée)
+struct BatchVerifier {
+    static constexpr size_t CHUNK = 256;
+
+    template<class Blocks>
+    static BatchVerifyResult verify(const Blocks& blocks, size_t first, size_t last, const StakeHistory& history, unsigned threads = 0) {
+        last = min(last, blocks.size());
+        if (first >= last) return {};
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        if (last - first < 4 * CHUNK) threads = 1;
+        vector<BatchVerifyResult> parts(threads);
+        auto worker = [&](unsigned t) {
+            if (t) Tracer::nameThread("vérification");
+            size_t lo = first + (last - first) * t / threads, hi = first + (last - first) * (t + 1) / threads;
+            TraceSpan span("vérification lot", "validation", (int64_t)(hi - lo));
+            verifyRange(blocks, lo, hi, history, parts[t]);
+        };
+        vector<thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (auto& th : pool) th.join();
+        BatchVerifyResult res;
+        for (auto& p : parts) {
+            res.badLink.insert(res.badLink.end(), p.badLink.begin(), p.badLink.end());
+            res.badHash.insert(res.badHash.end(), p.badHash.begin(), p.badHash.end());
+            res.badValidator.insert(res.badValidator.end(), p.badValidator.begin(), p.badValidator.end());
+        }
+        return res;
+    }
+
+private:
+    template<class Blocks>
+    static void verifyRange(const Blocks& blocks, size_t lo, size_t hi, const StakeHistory& history, BatchVerifyResult& res) {
+        vector<string> headers(CHUNK), seeds(CHUNK);
+        vector<const string*> headerPtr(CHUNK), seedPtr(CHUNK);
+        vector<HashWords> headerHash(CHUNK), seedHash(CHUNK);
+        for (size_t k = 0; k < CHUNK; ++k) { headerPtr[k] = &headers[k]; seedPtr[k] = &seeds[k]; }
+        const auto& epochs = history.epochs;
+        size_t epoch = SIZE_MAX;
+        uint64_t epochEnd = 0; // hauteur de la prochaine époque
+
+        for (size_t base = lo; base < hi; base += CHUNK) {
+            size_t n = min(CHUNK, hi - base);
+            for (size_t k = 0; k < n; ++k) {
+                const BlockTx& b = blocks[base + k];
+                headers[k].clear(); b.appendHeader(headers[k]);
+                seeds[k].clear(); seeds[k] += b.prevHash; seeds[k] += ':';
+                char num[24];
+                seeds[k].append(num, to_chars(num, num + sizeof num, (uint64_t)b.id).ptr);
+            }
+            fastHashBatch(headerPtr.data(), n, headerHash.data());
+            fastHashBatch(seedPtr.data(), n, seedHash.data());
+
+            for (size_t k = 0; k < n; ++k) {
+                size_t i = base + k;
+                const BlockTx& b = blocks[i];
+                char hex[64];
+                writeHex(headerHash[k], hex);
+                if (b.hash.size() != 64 || memcmp(b.hash.data(), hex, 64) != 0) res.badHash.push_back(i);
+                if (i > 0 && b.prevHash != blocks[i - 1].hash) res.badLink.push_back(i);
+                if (i == 0) continue; // genèse : pas de validateur
+
+                uint64_t h = (uint64_t)b.id;
+                if (epoch == SIZE_MAX || h < epochs[epoch].from || h >= epochEnd) {
+                    epoch = history.epochIndex(h);
+                    epochEnd = (epoch != SIZE_MAX && epoch + 1 < epochs.size()) ? epochs[epoch + 1].from : UINT64_MAX;
+                }
+                if (epoch == SIZE_MAX || b.validator != epochs[epoch].table->validatorForSeed(seedHash[k].w[0]))
+                    res.badValidator.push_back(i);
+            }
+        }
+    }
+};
+
+template<class Blocks>
+BatchVerifyResult verifyPoSBatch(const Blocks& blocks, size_t first, size_t last, const StakeHistory& history, unsigned threads = 0) {
+    return BatchVerifier::verify(blocks, first, last, history, threads);
+}
+
+// Politiques de consensus, choisies à la compilation : pipeline, chaîne et simulateur réseau sont
+// instanciés par type de consensus, sans appel virtuel ni test à l'exécution dans les boucles chaudes.
+// Une politique fournit :
+//   slotted          : true si un producteur est désigné par créneau (PoS, hybride)
+//   name()           : libellé pour l'affichage
+//   proposer(prev,h) : validateur désigné pour la hauteur h (politiques à créneaux)
+//   sealStep(b,max)  : avance le scellement d'au plus max hashes ; true quand le bloc est scellé
+//   seal(b)          : scellement complet
+//   verify(b)        : règle propre au consensus (hash et Merkle sont vérifiés à part)
+// Ajouter un consensus revient à écrire une politique : BlockTx et Blockchain ne changent pas.
+inline bool meetsDifficulty(const string& hash, int difficulty) {
+    if ((int)hash.size() < difficulty) return false;
+    for (int i = 0; i < difficulty; ++i) if (hash[i] != '0') return false;
+    return true;
+}
+
+struct PoWConsensus {
+    static constexpr bool slotted = false;
+    int difficulty;
+
+    explicit PoWConsensus(int d) : difficulty(d) {}
+    static const char* name() { return "PoW"; }
+    string proposer(const string&, uint64_t) const { return ""; }
+    bool sealStep(BlockTx& b, uint64_t maxHashes) const {
+        for (uint64_t i = 0; i < maxHashes; ++i) { ++b.nonce; b.calculateHash(); if (meetsDifficulty(b.hash, difficulty)) return true; }
+        return false;
+    }
+    void seal(BlockTx& b) const { b.mineBlock(difficulty); }
+    bool verify(const BlockTx& b) const { return meetsDifficulty(b.hash, difficulty); }
+};
+
+struct PoSConsensus {
+    static constexpr bool slotted = true;
+    const PoSSystem* pos;
+
+    explicit PoSConsensus(const PoSSystem& p) : pos(&p) {}
+    static const char* name() { return "PoS"; }
+    string proposer(const string& prevHash, uint64_t h) const { return pos->chooseValidator(prevHash, h); }
+    bool sealStep(BlockTx& b, uint64_t) const { seal(b); return true; }
+    void seal(BlockTx& b) const { TraceSpan span("sélection PoS", "pos", b.id); b.validatePoS(proposer(b.prevHash, b.id)); }
+    bool verify(const BlockTx& b) const { return !b.validator.empty() && pos->verifyValidator(b); }
+};
+
+// Hybride : producteur désigné par PoS, qui doit en plus atteindre une cible PoW légère
+struct HybridConsensus {
+    static constexpr bool slotted = true;
+    const PoSSystem* pos;
+    int difficulty;
+
+    HybridConsensus(const PoSSystem& p, int d) : pos(&p), difficulty(d) {}
+    static const char* name() { return "Hybride"; }
+    string proposer(const string& prevHash, uint64_t h) const { return pos->chooseValidator(prevHash, h); }
+    bool sealStep(BlockTx& b, uint64_t maxHashes) const {
+        if (b.validator.empty()) b.validator = proposer(b.prevHash, b.id);
+        for (uint64_t i = 0; i < maxHashes; ++i) { ++b.nonce; b.calculateHash(); if (meetsDifficulty(b.hash, difficulty)) return true; }
+        return false;
+    }
+    void seal(BlockTx& b) const { TraceSpan span("scellement hybride", "minage", b.id); while (!sealStep(b, UINT64_MAX)) {} }
+    bool verify(const BlockTx& b) const { return !b.validator.empty() && pos->verifyValidator(b) && meetsDifficulty(b.hash, difficulty); }
+};
+
+// Temps de scellement d'un bloc (ns, horloge monotone) pour un consensus donné
+template<class Consensus>
+long long simulateSeal(BlockTx& block, const Consensus& consensus){ auto start=steady_clock::now(); consensus.seal(block); auto end=steady_clock::now(); return duration_cast<nanoseconds>(end-start).count(); }
+
+// Hashes calculés pour sceller un bloc : le nonce compte les essais PoW, un bloc PoS en calcule un
+inline uint64_t sealAttempts(const BlockTx& b) { return b.nonce ? b.nonce : 1; }
+
+// Chaîne vue à travers un consensus : production (scellement + ajout) et validation complète
+template<class Consensus>
+class ConsensusChain {
+public:
+    Blockchain& chain;
+    Consensus consensus;
+
+    ConsensusChain(Blockchain& c, Consensus cons) : chain(c), consensus(cons) {}
+
+    // Scelle un bloc au sommet de la chaîne puis l'ajoute ; false si le registre le refuse
+    bool produce(TxColumns txs) {
+        BlockTx b(chain.chain.back().id + 1, chain.chain.back().hash, std::move(txs));
+        consensus.seal(b);
+        return chain.addBlock(b);
+    }
+
+    // Comme Blockchain::isValid, avec en plus la règle du consensus pour chaque bloc
+    bool isValid() const {
+        auto view = chain.chain.snapshot();
+        SeenTxIndex walked;
+        for (size_t i = 0; i < view.size(); ++i) {
+            const BlockTx& b = view[i];
+            if (i > 0 && (b.prevHash != view[i-1].hash || !consensus.verify(b) || !b.hashMatches())) return false;
+            if (walked.findDuplicates(b.transactions)) return false;
+            walked.insertBlock(b.transactions);
+        }
+        return true;
+    }
+};
+
+
+// ===================== Mesures =====================
+
+// Histogramme à la HDR : 2^SUB_BITS sous-intervalles par puissance de deux, soit une erreur
+// relative inférieure à 1/32 sur toute la plage 64 bits, avec une taille fixe (1920 compteurs)
+// et un enregistrement en O(1). Sert aux latences (ns) comme aux comptes de hashes.
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB = 1ULL << SUB_BITS;
+
+    Histogram() : counts((64 - SUB_BITS + 1) * SUB, 0) {}
+
+    void record(uint64_t v) {
+        ++counts[bucketOf(v)]; ++n; sum += v;
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+    }
+    void merge(const Histogram& o) {
+        for (size_t k = 0; k < counts.size(); ++k) counts[k] += o.counts[k];
+        n += o.n; sum += o.sum; lo = std::min(lo, o.lo); hi = std::max(hi, o.hi);
+    }
+
+    uint64_t count() const { return n; }
+    uint64_t min() const { return n ? lo : 0; }
+    uint64_t max() const { return hi; }
+    double mean() const { return n ? (double)sum / n : 0; }
+    // Plus petite valeur v telle qu'au moins q (0..1) des mesures soient <= v (borne haute du compteur)
+    uint64_t percentile(double q) const {
+        if (n == 0) return 0;
+        uint64_t rank = (uint64_t)ceil(q * n), seen = 0;
+        if (rank == 0) rank = 1;
+        for (size_t k = 0; k < counts.size(); ++k) {
+            seen += counts[k];
+            if (seen >= rank) return std::min(hi, highestOf(k));
+        }
+        return hi;
+    }
+
+private:
+    vector<uint64_t> counts;
+    uint64_t n = 0, lo = UINT64_MAX, hi = 0;
+    unsigned __int128 sum = 0;
+
+    static size_t bucketOf(uint64_t v) {
+        if (v < SUB) return v;
+        int e = 63 - __builtin_clzll(v);
+        return (size_t(e - SUB_BITS + 1) << SUB_BITS) + ((v >> (e - SUB_BITS)) & (SUB - 1));
+    }
+    static uint64_t highestOf(size_t k) {
+        if (k < SUB) return k;
+        int shift = int(k >> SUB_BITS) - 1;
+        uint64_t low = (SUB + (k & (SUB - 1))) << shift;
+        return low + ((1ULL << shift) - 1);
+    }
+};
+
+// Libellé complété à width caractères affichés (setw compte les octets, pas les caractères UTF-8)
+string padLabel(const string& label, size_t width);
+
+// Résultat d'une boucle mesurée, rendu observable sans l'afficher : l'optimiseur ne peut plus
+// supprimer le calcul qui le produit (barrière vide, ni instruction ni écriture en sortie)
+template<class T>
+inline void keepResult(const T& value) { asm volatile("" : : "r"(&value) : "memory"); }
+
+// Compteurs matériels (perf_event_open, Linux) du thread appelant, par phase.
+// Chaque compteur est ouvert séparément : ceux que le processeur ou la machine virtuelle
+// n'exposent pas sont simplement absents. Hors Linux, ou si perf_event_paranoid l'interdit,
+// available() est faux et seules les durées et les allocations sont mesurées.
+struct PerfSample {
+    enum { CYCLES, INSTRUCTIONS, BRANCH_MISSES, LLC_MISSES, COUNT };
+    static const char* label(int k) { static const char* names[] = {"cycles", "instructions", "branch-misses", "LLC-load-misses"}; return names[k]; }
+    bool valid[COUNT] = {};
+    uint64_t value[COUNT] = {};
+    double ms = 0;
+    AllocSample allocs;        // allocations du thread pendant la mesure (si allocStatsAvailable())
+
+    double ipc() const { return valid[CYCLES] && valid[INSTRUCTIONS] && value[CYCLES] ? (double)value[INSTRUCTIONS] / value[CYCLES] : 0; }
+    void add(const PerfSample& o) {
+        for (int k = 0; k < COUNT; ++k) { valid[k] = valid[k] && o.valid[k]; value[k] += o.value[k]; }
+        ms += o.ms;
+        allocs += o.allocs;
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { for (int fd : fds) if (fd >= 0) return true; return false; }
+    const string& unavailableReason() const { return reason; }
+
+    void start();
+    PerfSample stop();
+
+private:
+    int fds[PerfSample::COUNT] = {-1, -1, -1, -1};
+    string reason;
+    steady_clock::time_point t0;
+    AllocSample alloc0;
+};
+
+// Profil par phase : mesure(phase, f) exécute f entre start() et stop() et cumule l'échantillon
+class PhaseProfiler {
+public:
+    template<class F>
+    void measure(const string& phase, F&& f) {
+        counters.start();
+        f();
+        PerfSample s = counters.stop();
+        auto it = find_if(phases.begin(), phases.end(), [&](const pair<string, PerfSample>& p) { return p.first == phase; });
+        if (it == phases.end()) phases.push_back({phase, s});
+        else it->second.add(s);
+    }
+
+    void print(ostream& out) const {
+        if (!counters.available()) out << "Compteurs matériels indisponibles (" << counters.unavailableReason() << ") : durées et allocations seules\n";
+        out << left << padLabel("Phase", 22) << setw(12) << "ms" << setw(12) << "allocs" << setw(14) << "Ko alloués";
+        for (int k = 0; k < PerfSample::COUNT; ++k) out << setw(16) << PerfSample::label(k);
+        out << "IPC\n" << string(22 + 12 + 12 + 14 + 16 * PerfSample::COUNT + 6, '-') << "\n";
+        out << fixed;
+        for (auto& [phase, s] : phases) {
+            out << padLabel(phase, 22) << setprecision(2) << setw(12) << s.ms;
+            if (allocStatsAvailable()) out << setw(12) << s.allocs.count << setprecision(1) << setw(14) << s.allocs.bytes / 1024.0;
+            else out << setw(12) << "n/d" << setw(14) << "n/d";
+            for (int k = 0; k < PerfSample::COUNT; ++k) {
+                if (s.valid[k]) out << setw(16) << s.value[k];
+                else out << setw(16) << "n/d";
+            }
+            if (s.ipc() > 0) out << setprecision(2) << s.ipc();
+            else out << "n/d";
+            out << "\n";
+        }
+        out.unsetf(ios::fixed);
+        out << setprecision(6) << right;
+    }
+
+private:
+    PerfCounters counters;
+    vector<pair<string, PerfSample>> phases;
+};
+
+// Temps CPU consommé par le thread appelant (ms) ; temps CPU du processus à défaut
+double threadCpuMs();
+
+
+// File bornée entre deux étages : push bloque quand la file est pleine (contre-pression),
+// pop bloque quand elle est vide ; après close, pop vide ce qui reste puis renvoie false.
+template<class T>
+class BoundedQueue {
+private:
+    mutex mtx;
+    condition_variable notFull, notEmpty;
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BoundedQueue(size_t cap) : capacity(cap) {}
+
+    bool push(T item) {
+        unique_lock<mutex> lock(mtx);
+        notFull.wait(lock, [&]{ return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T& out) {
+        unique_lock<mutex> lock(mtx);
+        notEmpty.wait(lock, [&]{ return !items.empty() || closed; });
+        if (items.empty()) return false;
+        out = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lock(mtx);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+// Production de blocs en pipeline, trois étages reliés par des files bornées :
+//   1. préparation (thread dédié) : gabarit tiré du mempool, contrôle des soldes sur un registre
+//      anticipé (les transactions refusées sont écartées), racine Merkle ;
+//   2. minage (thread appelant) : seul étage sur le chemin critique, il enchaîne directement
+//      sur le hash du bloc qu'il vient de produire ;
+//   3. ajout (thread dédié) : addBlock puis onAppend (affichage, persistance...).
+// Un bloc refusé par addBlock arrête la production : les blocs suivants, minés sur son hash,
+// ne pourraient plus se raccrocher à la chaîne. rejectedBlock en garde l'id.
+struct PipelineStats {
+    size_t blocks = 0;
+    int rejectedBlock = -1;   // id du bloc refusé par la chaîne (-1 : aucun)
+    size_t droppedTxs = 0;    // écartées par le registre (solde insuffisant)
+    size_t duplicateTxs = 0;  // écartées comme rejeux (déjà dans la chaîne ou déjà préparées)
+    long long miningNs = 0;   // temps passé à miner / valider
+    long long stallNs = 0;    // temps où le mineur attendait un bloc préparé
+    long long totalNs = 0;
+    Histogram sealNs;         // latence de scellement par bloc
+    Histogram attempts;       // hashes calculés par bloc
+    uint64_t hashes = 0;
+    double cpuPrepareMs = 0, cpuSealMs = 0, cpuAppendMs = 0; // temps CPU de chaque étape
+    AllocSample allocPrepare, allocSeal, allocAppend;         // allocations de chaque étape
+
+    double hashRate() const { return miningNs ? hashes * 1e9 / miningNs : 0; }
+    bool ok() const { return rejectedBlock < 0; }
+};
+
+class BlockPipeline {
+private:
+    Blockchain& chain;
+    Mempool& mempool;
+    size_t txsPerBlock;
+    size_t depth;
+    unsigned ledgerThreads;
+
+    struct PreparedBlock { TxColumns txs; string merkleRoot; };
+    struct MinedBlock { BlockTx block; long long ns; };
+
+    // Retire du gabarit les transactions déjà dans la chaîne, déjà préparées ou répétées ;
+    // renvoie leur nombre
+    size_t dropReplays(TxColumns& txs, const SeenTxIndex& queued) {
+        size_t n = txs.size(), dups = 0;
+        ArenaScope scratch;
+        uint64_t* d = scratch.alloc<uint64_t>(n);
+        char* dup = scratch.alloc<char>(n);
+        fill_n(dup, n, 0);
+        SeenTxIndex::digests(txs, d);
+        chain.seen.mark(d, n, dup);
+        queued.mark(d, n, dup);
+        SeenTxIndex::markRepeats(d, n, dup);
+        for (size_t k = 0; k < n; ++k) dups += dup[k];
+        if (!dups) return 0;
+        TxColumns kept;
+        kept.reserve(n - dups);
+        for (size_t k = 0; k < n; ++k) if (!dup[k]) kept.push(txs.get(k));
+        txs = std::move(kept);
+        return dups;
+    }
+
+public:
+    BlockPipeline(Blockchain& c, Mempool& m, size_t txs, size_t queueDepth = 4, unsigned threads = 0)
+        : chain(c), mempool(m), txsPerBlock(txs), depth(queueDepth), ledgerThreads(threads) {}
+
+    // Produit au plus nBlocks blocs (moins si le mempool se vide), scellés selon consensus.
+    // onAppend reçoit chaque bloc ajouté et son temps de scellement (ns).
+    template<class Consensus>
+    PipelineStats run(size_t nBlocks, const Consensus& consensus,
+                      function<void(const BlockTx&, long long)> onAppend = nullptr) {
+        PipelineStats stats;
+        auto start = steady_clock::now();
+        BoundedQueue<PreparedBlock> prepared(depth);
+        BoundedQueue<MinedBlock> mined(depth);
+        atomic<bool> failed{false};
+
+        thread preparer([&]{
+            Tracer::nameThread("préparation");
+            double cpu0 = threadCpuMs();
+            AllocSample alloc0 = threadAllocations();
+            Ledger pending = chain.ledger;
+            SeenTxIndex queued; // transactions des blocs préparés pendant ce run, ajoutés ou non
+            for (size_t i = 0; i < nBlocks; ++i) {
+                TraceSpan span("préparation bloc", "pipeline");
+                TxColumns txs;
+                {
+                    TraceSpan tpl("gabarit mempool", "pipeline");
+                    txs = mempool.buildTemplate(txsPerBlock);
+                }
+                if (txs.size() == 0) break;
+                span.setArg((int64_t)txs.size());
+                if (size_t dups = dropReplays(txs, queued)) {
+                    stats.duplicateTxs += dups;
+                    if (txs.size() == 0) { --i; continue; } // gabarit entièrement rejoué : le suivant
+                }
+                vector<size_t> rejected;
+                if (!pending.applyBlock(txs, &rejected, ledgerThreads)) {
+                    // Une transaction refusée ne modifie aucun solde : les autres restent valides sans elle
+                    TxColumns kept;
+                    kept.reserve(txs.size() - rejected.size());
+                    for (size_t k = 0, r = 0; k < txs.size(); ++k) {
+                        if (r < rejected.size() && rejected[r] == k) { ++r; continue; }
+                        kept.push(txs.get(k));
+                    }
+                    stats.droppedTxs += rejected.size();
+                    pending.applyBlock(kept, nullptr, ledgerThreads);
+                    txs = std::move(kept);
+                }
+                queued.insertBlock(txs);
+                string root = computeTxMerkleRoot(txs);
+                if (!prepared.push({std::move(txs), std::move(root)})) break;
+            }
+            prepared.close();
+            stats.cpuPrepareMs = threadCpuMs() - cpu0;
+            stats.allocPrepare = threadAllocations() - alloc0;
+        });
+
+        thread appender([&]{
+            Tracer::nameThread("ajout");
+            double cpu0 = threadCpuMs();
+            AllocSample alloc0 = threadAllocations();
+            MinedBlock m;
+            while (mined.pop(m)) {
+                if (failed.load(memory_order_relaxed)) continue; // vidange : le mineur ne reste pas bloqué
+                if (!chain.addBlock(m.block)) {
+                    stats.rejectedBlock = m.block.id;
+                    failed.store(true);
+                    prepared.close();
+                    continue;
+                }
+                ++stats.blocks;
+                if (onAppend) { TraceSpan span("rappel onAppend", "sortie", m.block.id); onAppend(m.block, m.ns); }
+            }
+            stats.cpuAppendMs = threadCpuMs() - cpu0;
+            stats.allocAppend = threadAllocations() - alloc0;
+        });
+
+        int nextId = chain.chain.back().id + 1;
+        string tip = chain.chain.back().hash;
+        PreparedBlock pb;
+        for (;;) {
+            auto w0 = steady_clock::now();
+            bool got;
+            { TraceSpan wait("attente préparation", "pipeline"); got = prepared.pop(pb); }
+            auto t0 = steady_clock::now();
+            stats.stallNs += duration_cast<nanoseconds>(t0 - w0).count();
+            if (!got || failed.load()) break;
+            BlockTx b(nextId++, tip, std::move(pb.txs), std::move(pb.merkleRoot));
+            double cpu0 = threadCpuMs();
+            AllocSample alloc0 = threadAllocations();
+            consensus.seal(b);
+            stats.allocSeal += threadAllocations() - alloc0;
+            long long ns = duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+            stats.cpuSealMs += threadCpuMs() - cpu0;
+            stats.miningNs += ns;
+            stats.sealNs.record(ns);
+            stats.attempts.record(sealAttempts(b));
+            stats.hashes += sealAttempts(b);
+            tip = b.hash;
+            mined.push({std::move(b), ns});
+        }
+        mined.close();
+        preparer.join();
+        appender.join();
+        stats.totalNs = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+        return stats;
+    }
+};
+
+
+// Minage asynchrone : chaque bloc est miné par tous les threads du pool (nonces entrelacés).
+// L'indicateur d'annulation est relu à chaque hash : un minage annulé (bloc concurrent reçu)
+// libère ses threads en quelques microsecondes. Le travail des minages annulés est comptabilisé.
+struct MiningResult {
+    bool found = false;          // false : minage annulé
+    BlockTx block;
+    uint64_t hashes = 0;
+    long long micros = 0;
+};
+
+struct MiningStats {
+    size_t jobs = 0, cancelledJobs = 0;
+    uint64_t usefulHashes = 0, wastedHashes = 0;
+    long long wastedMicros = 0;  // temps écoulé des minages annulés
+};
+
+class AsyncMiner;
+
+class MiningHandle {
+public:
+    future<MiningResult> result;
+    void cancel() { if (cancelled) *cancelled = true; }
+
+private:
+    shared_ptr<atomic<bool>> cancelled;
+    friend class AsyncMiner;
+};
+
+class AsyncMiner {
+private:
+    struct Job {
+        BlockTx block;
+        int difficulty;
+        shared_ptr<atomic<bool>> cancelled;
+        atomic<bool> done{false};
+        atomic<uint64_t> hashes{0};
+        atomic<unsigned> remaining{0};
+        mutex mtx;
+        bool found = false;          // nonce gagnant et hash, sous mtx
+        uint64_t foundNonce = 0;
+        string foundHash;
+        promise<MiningResult> resultPromise;
+        steady_clock::time_point start;
+    };
+
+    mutable mutex statsMtx;
+    MiningStats totals;
+    atomic<bool> closing{false};
+    // Dernier membre : détruit en premier, ses threads finissent avant statsMtx et totals
+    WorkerPool pool;
+
+    // Le thread offset essaie nonce+offset, nonce+offset+step... sur une copie de l'en-tête seul
+    void work(const shared_ptr<Job>& job, unsigned offset, unsigned step) {
+        TraceSpan span("minage (thread)", "minage", job->block.id);
+        BlockTx h = job->block.header();
+        h.nonce += offset;
+        string target(job->difficulty, '0');
+        uint64_t local = 0;
+        while (!job->cancelled->load(memory_order_relaxed) && !job->done.load(memory_order_relaxed)
+               && !closing.load(memory_order_relaxed)) {
+            h.calculateHash();
+            ++local;
+            if (h.hash.compare(0, job->difficulty, target) == 0) {
+                if (!job->done.exchange(true)) {
+                    lock_guard<mutex> lock(job->mtx);
+                    job->found = true;
+                    job->foundNonce = h.nonce;
+                    job->foundHash = std::move(h.hash);
+                }
+                break;
+            }
+            h.nonce += step;
+        }
+        job->hashes += local;
+        if (--job->remaining == 0) finish(job);
+    }
+
+    void finish(const shared_ptr<Job>& job) {
+        MiningResult r;
+        r.block = std::move(job->block);
+        {
+            lock_guard<mutex> lock(job->mtx);
+            r.found = job->found;
+            if (r.found) { r.block.nonce = job->foundNonce; r.block.hash = std::move(job->foundHash); }
+        }
+        r.hashes = job->hashes;
+        r.micros = duration_cast<microseconds>(steady_clock::now() - job->start).count();
+        {
+            lock_guard<mutex> lock(statsMtx);
+            ++totals.jobs;
+            if (r.found) totals.usefulHashes += r.hashes;
+            else { ++totals.cancelledJobs; totals.wastedHashes += r.hashes; totals.wastedMicros += r.micros; }
+        }
+        job->resultPromise.set_value(std::move(r));
+    }
+
+public:
+    explicit AsyncMiner(unsigned threads = 0) : pool(threads) {}
+    // Les minages encore en cours sont annulés : leurs résultats sont livrés avec found = false
+    ~AsyncMiner() { closing = true; }
+
+    MiningHandle mine(const BlockTx& b, int difficulty) {
+        auto job = make_shared<Job>();
+        job->block = b;
+        job->difficulty = difficulty;
+        job->cancelled = make_shared<atomic<bool>>(false);
+        job->remaining = pool.size();
+        job->start = steady_clock::now();
+        MiningHandle h;
+        h.result = job->resultPromise.get_future();
+        h.cancelled = job->cancelled;
+        for (unsigned t = 0; t < pool.size(); ++t) pool.submit([this, job, t]{ work(job, t, pool.size()); });
+        return h;
+    }
+
+    // Bloc concurrent reçu : abandonne le parent périmé et repart sur le nouveau
+    MiningHandle restart(MiningHandle& current, const BlockTx& b, int difficulty) {
+        current.cancel();
+        return mine(b, difficulty);
+    }
+
+    MiningStats stats() const { lock_guard<mutex> lock(statsMtx); return totals; }
+};
+
+// Simulateur réseau en processus : N nœuds (un thread chacun) avec leur propre vue de la chaîne,
+// reliés par des canaux en mémoire (latence, bande passante, perte). Les nœuds diffusent
+// transactions et blocs de proche en proche ; la règle de choix est la chaîne la plus haute
+// (à hauteur égale, le premier bloc reçu). Pas de registre des soldes dans la simulation.
+struct NetworkConfig {
+    int nodes = 4;
+    double latencyMs = 20;
+    double bandwidthMbps = 10;
+    double lossRate = 0.01;
+    int targetHeight = 30;
+    int difficulty = 3;          // PoW
+    int hybridDifficulty = 2;    // cible PoW légère du mode hybride
+    int slotMs = 100;            // PoS : durée d'un créneau
+    size_t txsPerBlock = 200;
+    double txPerSecond = 1000;   // pour l'ensemble du réseau
+    uint64_t seed = 1;
+};
+
+struct NetworkReport {
+    double seconds = 0;
+    int height = 0;
+    size_t producedBlocks = 0;
+    double orphanRate = 0;
+    double blocksPerSec = 0, txPerSec = 0;
+    double confirmMeanMs = 0, confirmP50Ms = 0, confirmMaxMs = 0;
+    size_t messages = 0, dropped = 0;
+    int agreeingNodes = 0;
+    size_t reorgs = 0, requeuedTxs = 0;  // nœud 0 : changements de branche, transactions remises en attente
+    bool confirmedMatchesChain = true;   // nœud 0 : les ids confirmés sont exactement ceux de sa chaîne principale
+};
+
+struct NetMessage {
+    steady_clock::time_point deliverAt;
+    int from;
+    shared_ptr<const BlockTx> block; // bloc diffusé, sinon transaction
+    Transaction tx;
+};
+
+// Boîte de réception d'un nœud : messages triés par heure de livraison
+class NetInbox {
+private:
+    struct Later { bool operator()(const NetMessage& a, const NetMessage& b) const { return a.deliverAt > b.deliverAt; } };
+    mutex mtx;
+    condition_variable cv;
+    priority_queue<NetMessage, vector<NetMessage>, Later> queue;
+
+public:
+    void put(NetMessage m) {
+        lock_guard<mutex> lock(mtx);
+        queue.push(std::move(m));
+        cv.notify_one();
+    }
+
+    // Message arrivé à échéance, en attendant au plus jusqu'à until
+    bool take(NetMessage& out, steady_clock::time_point until) {
+        unique_lock<mutex> lock(mtx);
+        for (;;) {
+            auto now = steady_clock::now();
+            if (!queue.empty() && queue.top().deliverAt <= now) { out = queue.top(); queue.pop(); return true; }
+            if (now >= until) return false;
+            auto wakeAt = queue.empty() ? until : min(until, queue.top().deliverAt);
+            cv.wait_until(lock, wakeAt);
+        }
+    }
+};
+
+// Validateurs du réseau simulé : un par nœud ("node0", "node1"...), stakes croissants
+vector<pair<string,uint64_t>> networkValidators(const NetworkConfig& cfg);
+
+template<class Consensus>
+class NetworkSimulator {
+private:
+    struct BlockInfo { shared_ptr<const BlockTx> block; int height; steady_clock::time_point seenAt; };
+
+    struct Node {
+        string name;
+        NetInbox inbox;
+        unordered_map<string, BlockInfo> blocks;
+        unordered_map<string, vector<shared_ptr<const BlockTx>>> waitingParent;
+        string tip;
+        int tipHeight = 0;
+        Mempool mempool;
+        unordered_set<int> confirmed;                   // ids des transactions de la chaîne principale
+        size_t reorgs = 0, requeued = 0;
+        vector<steady_clock::time_point> linkFree;      // liaison sortante vers chaque pair
+        mt19937_64 rng;
+    };
+
+    NetworkConfig cfg;
+    Consensus consensus;
+    vector<unique_ptr<Node>> nodes;
+    vector<AccountId> simAccounts;
+    atomic<bool> stop{false};
+    atomic<size_t> produced{0}, messages{0}, dropped{0};
+    mutex createdMtx;
+    vector<steady_clock::time_point> createdAt; // par id de transaction
+    steady_clock::time_point start;
+
+    void send(Node& from, int fromIdx, const NetMessage& proto, size_t bytes, int except) {
+        auto now = steady_clock::now();
+        for (int to = 0; to < cfg.nodes; ++to) {
+            if (to == fromIdx || to == except) continue;
+            ++messages;
+            if (uniform_real_distribution<double>(0, 1)(from.rng) < cfg.lossRate) { ++dropped; continue; }
+            // La liaison transmet un message à la fois : l'envoi attend qu'elle soit libre
+            auto sendAt = max(now, from.linkFree[to]);
+            auto txTime = duration_cast<steady_clock::duration>(duration<double, micro>(bytes * 8.0 / cfg.bandwidthMbps));
+            from.linkFree[to] = sendAt + txTime;
+            NetMessage m = proto;
+            m.deliverAt = from.linkFree[to] + duration_cast<steady_clock::duration>(duration<double, milli>(cfg.latencyMs));
+            nodes[to]->inbox.put(std::move(m));
+        }
+    }
+
+    void broadcastBlock(int idx, const shared_ptr<const BlockTx>& b, int except) {
+        string buf;
+        encodeBlock(*b, buf);
+        send(*nodes[idx], idx, NetMessage{{}, idx, b, Transaction(0, (AccountId)0, (AccountId)0, (Amount)0)}, buf.size(), except);
+    }
+
+    bool checkBlock(const BlockTx& b) const {
+        TraceSpan span("contrôle bloc reçu", "validation", b.id);
+        return b.hashMatches() && computeTxMerkleRoot(b.transactions) == b.merkleRoot && consensus.verify(b);
+    }
+
+    void acceptBlock(int idx, const shared_ptr<const BlockTx>& b, int from) {
+        Node& n = *nodes[idx];
+        if (n.blocks.count(b->hash) || !checkBlock(*b)) return;
+        auto parent = n.blocks.find(b->prevHash);
+        if (parent == n.blocks.end()) { n.waitingParent[b->prevHash].push_back(b); return; }
+        int height = parent->second.height + 1;
+        n.blocks[b->hash] = {b, height, steady_clock::now()};
+        // Un bloc de branche latérale ne confirme rien tant qu'il ne porte pas la meilleure chaîne
+        if (height > n.tipHeight) {
+            switchTip(n, b->hash, height);
+            if (height >= cfg.targetHeight) stop = true;
+        }
+        broadcastBlock(idx, b, from);
+        auto waiting = n.waitingParent.find(b->hash);
+        if (waiting != n.waitingParent.end()) {
+            vector<shared_ptr<const BlockTx>> children = std::move(waiting->second);
+            n.waitingParent.erase(waiting);
+            for (auto& c : children) acceptBlock(idx, c, -1);
+        }
+    }
+
+    // Remet en attente les transactions d'un bloc sorti de la chaîne principale
+    void requeue(Node& n, const TxColumns& t) {
+        for (size_t k = 0; k < t.size(); ++k)
+            if (!n.confirmed.count(t.ids[k]) && n.mempool.submit(t.get(k), t.amounts[k])) ++n.requeued;
+    }
+
+    // Nouvelle tête : on remonte les deux branches jusqu'à l'ancêtre commun. Les blocs
+    // quittant la chaîne principale rendent leurs transactions au mempool, ceux qui la
+    // rejoignent les confirment. confirmed reste l'ensemble des ids de la chaîne principale.
+    void switchTip(Node& n, const string& newTip, int newHeight) {
+        vector<const BlockTx*> left, joined;
+        string a = n.tip, b = newTip;
+        int ha = n.tipHeight, hb = newHeight;
+        auto back = [&](string& h, int& height, vector<const BlockTx*>& out) {
+            const BlockTx* blk = n.blocks[h].block.get();
+            out.push_back(blk);
+            h = blk->prevHash;
+            --height;
+        };
+        while (hb > ha) back(b, hb, joined);
+        while (ha > hb) back(a, ha, left);
+        while (a != b) { back(a, ha, left); back(b, hb, joined); }
+        if (!left.empty()) ++n.reorgs;
+
+        for (const BlockTx* blk : left)
+            for (size_t k = 0; k < blk->transactions.size(); ++k) n.confirmed.erase(blk->transactions.ids[k]);
+        for (const BlockTx* blk : joined)
+            for (size_t k = 0; k < blk->transactions.size(); ++k) n.confirmed.insert(blk->transactions.ids[k]);
+        for (const BlockTx* blk : left) requeue(n, blk->transactions);
+        n.tip = newTip;
+        n.tipHeight = newHeight;
+    }
+
+    void handle(int idx, const NetMessage& m) {
+        Node& n = *nodes[idx];
+        if (m.block) acceptBlock(idx, m.block, m.from);
+        else if (!n.confirmed.count(m.tx.id)) n.mempool.submit(m.tx, m.tx.amount);
+    }
+
+    TxColumns candidateTxs(Node& n) {
+        TxColumns all = n.mempool.buildTemplate(cfg.txsPerBlock), kept;
+        for (size_t k = 0; k < all.size(); ++k) if (!n.confirmed.count(all.ids[k])) kept.push(all.get(k));
+        return kept;
+    }
+
+    void produce(int idx, BlockTx& b) {
+        ++produced;
+        auto sb = make_shared<const BlockTx>(std::move(b));
+        acceptBlock(idx, sb, -1);
+    }
+
+    void runNode(int idx) {
+        Tracer::nameThread("nœud");
+        Node& n = *nodes[idx];
+        double txInterval = cfg.nodes / cfg.txPerSecond; // secondes entre deux transactions de ce nœud
+        auto nextTx = start;
+        auto nextAnnounce = start;
+        unique_ptr<BlockTx> candidate;
+        NetMessage m{{}, 0, nullptr, Transaction(0, (AccountId)0, (AccountId)0, (Amount)0)};
+        while (!stop) {
+            auto now = steady_clock::now();
+            while (n.inbox.take(m, now)) handle(idx, m);
+            while (nextTx <= now) {
+                int id;
+                {
+                    lock_guard<mutex> lock(createdMtx);
+                    id = (int)createdAt.size();
+                    createdAt.push_back(now);
+                }
+                Transaction tx(id, simAccounts[n.rng() % simAccounts.size()], simAccounts[n.rng() % simAccounts.size()], (Amount)(1 + n.rng() % 1000));
+                n.mempool.submit(tx, tx.amount);
+                send(n, idx, NetMessage{{}, idx, nullptr, tx}, encodedTxSize(tx), -1);
+                nextTx += duration_cast<steady_clock::duration>(duration<double>(txInterval));
+            }
+            // Réannonce périodique de la tête : évite qu'une perte bloque un nœud
+            if (now >= nextAnnounce) {
+                broadcastBlock(idx, n.blocks[n.tip].block, -1);
+                nextAnnounce = now + milliseconds(cfg.slotMs * 5);
+            }
+
+            // Tout candidat construit sur une tête périmée est abandonné, ses transactions restent à inclure
+            if (candidate && candidate->prevHash != n.tip) { requeue(n, candidate->transactions); candidate.reset(); }
+            if constexpr (Consensus::slotted) {
+                int h = n.tipHeight + 1;
+                auto slotAt = start + milliseconds((long long)h * cfg.slotMs);
+                if (candidate || (now >= slotAt && consensus.proposer(n.tip, h) == n.name)) {
+                    if (!candidate) candidate.reset(new BlockTx(h, n.tip, candidateTxs(n)));
+                    if (consensus.sealStep(*candidate, 2000)) { produce(idx, *candidate); candidate.reset(); }
+                    continue;
+                }
+                // Hors de son créneau, le nœud attend un message, sa prochaine transaction ou le créneau suivant
+                auto wakeAt = min(nextTx, slotAt > now ? slotAt : now + milliseconds(1));
+                if (n.inbox.take(m, min(wakeAt, now + milliseconds(5)))) handle(idx, m);
+            } else {
+                if (!candidate) candidate.reset(new BlockTx(n.tipHeight + 1, n.tip, candidateTxs(n)));
+                if (consensus.sealStep(*candidate, 2000)) { produce(idx, *candidate); candidate.reset(); }
+            }
+        }
+        // Après l'arrêt, on laisse arriver les messages en vol pour que les vues convergent
+        auto drainUntil = steady_clock::now() + milliseconds((long long)(4 * cfg.latencyMs) + 50);
+        while (n.inbox.take(m, drainUntil)) handle(idx, m);
+    }
+
+public:
+    NetworkSimulator(const NetworkConfig& c, Consensus cons) : cfg(c), consensus(cons) {}
+
+    NetworkReport run() {
+        stop = false;
+        produced = messages = dropped = 0;
+        createdAt.clear();
+        nodes.clear();
+        simAccounts.clear();
+        for (int i = 0; i < 100; ++i) simAccounts.push_back(accounts().intern("net" + to_string(i)));
+
+        auto genesis = make_shared<const BlockTx>(Blockchain().chain[0]);
+        start = steady_clock::now();
+        for (int i = 0; i < cfg.nodes; ++i) {
+            nodes.emplace_back(new Node);
+            Node& n = *nodes.back();
+            n.name = "node" + to_string(i);
+            n.blocks[genesis->hash] = {genesis, 0, start};
+            n.tip = genesis->hash;
+            n.linkFree.assign(cfg.nodes, start);
+            n.rng.seed(cfg.seed * 1000003 + i);
+        }
+        vector<thread> threads;
+        for (int i = 0; i < cfg.nodes; ++i) threads.emplace_back(&NetworkSimulator::runNode, this, i);
+        for (auto& t : threads) t.join();
+        auto end = steady_clock::now();
+
+        NetworkReport r;
+        Node& ref = *nodes[0];
+        r.seconds = duration<double>(end - start).count();
+        r.height = ref.tipHeight;
+        r.producedBlocks = produced;
+        r.orphanRate = produced ? 1.0 - (double)r.height / produced : 0;
+        r.messages = messages;
+        r.dropped = dropped;
+
+        // Chaîne principale du nœud 0 et latence de confirmation (création -> réception du bloc par le nœud 0)
+        vector<string> main(r.height + 1);
+        vector<double> latencies;
+        size_t txs = 0;
+        for (string h = ref.tip; ; ) {
+            const BlockInfo& info = ref.blocks[h];
+            main[info.height] = h;
+            if (info.height == 0) break;
+            const TxColumns& t = info.block->transactions;
+            txs += t.size();
+            for (size_t k = 0; k < t.size(); ++k)
+                latencies.push_back(duration<double, milli>(info.seenAt - createdAt[t.ids[k]]).count());
+            h = info.block->prevHash;
+        }
+        r.reorgs = ref.reorgs;
+        r.requeuedTxs = ref.requeued;
+        r.confirmedMatchesChain = latencies.size() == ref.confirmed.size();
+        for (size_t i = 1; i < main.size() && r.confirmedMatchesChain; ++i) {
+            const TxColumns& t = ref.blocks[main[i]].block->transactions;
+            for (size_t k = 0; k < t.size(); ++k) if (!ref.confirmed.count(t.ids[k])) r.confirmedMatchesChain = false;
+        }
+        r.blocksPerSec = r.height / r.seconds;
+        r.txPerSec = txs / r.seconds;
+        if (!latencies.empty()) {
+            sort(latencies.begin(), latencies.end());
+            double sum = 0;
+            for (double l : latencies) sum += l;
+            r.confirmMeanMs = sum / latencies.size();
+            r.confirmP50Ms = latencies[latencies.size() / 2];
+            r.confirmMaxMs = latencies.back();
+        }
+        // Nœuds d'accord avec le nœud 0 deux blocs sous sa tête
+        int check = max(0, r.height - 2);
+        for (auto& np : nodes) {
+            string h = np->tip;
+            while (np->blocks[h].height > check) h = np->blocks[h].block->prevHash;
+            if (np->blocks[h].height == check && h == main[check]) ++r.agreeingNodes;
+        }
+        return r;
+    }
+};
+
+#endif // BLOCKCHAIN_CORE_H
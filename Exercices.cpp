@@ -0,0 +1,214 @@
+#include "BlockchainCore.h"
+#include "Exercices.h"
+
+void runExercice1() {
+    vector<string> transactions = {
+        "Zineb-> Merieme : 10 BTC",
+        "Hamza -> Sara : 5 BTC",
+        "Mehdi -> Yassir : 2 BTC",
+        "Sara -> Karim : 1 BTC",
+        "Siham->Salma : 8 BTC",
+        "Reda -> Nora : 12 BTC",
+        "Khouloud -> Soumaia : 6BTC",
+        "Aya -> Zineb: 3 BTC"
+    };
+    cout << "=== Transactions ===\n";
+    for (size_t i=0;i<transactions.size();++i)
+        cout << "Transaction " << i+1 << ": " << transactions[i] << endl;
+
+    MerkleTree merkle(transactions);
+    merkle.display();
+    cout << "\nMerkle Root: " << merkle.getRootHash() << endl;
+}
+
+
+// Exercice 2 : PoW simple (mêmes blocs que les exercices 3 et 4, sans transactions)
+void printBlockInfo(const BlockTx& b) {
+    string_view prev(b.prevHash), root(b.merkleRoot);
+    cout << "Bloc ID: " << b.id << "\n"
+         << "  Timestamp  : " << b.timestamp << "\n"
+         << "  PrevHash   : " << prev.substr(0,20) << "...\n"
+         << "  MerkleRoot : " << root.substr(0,20) << "...\n"
+         << "  Nonce      : " << b.nonce << "\n"
+         << "  Hash       : " << b.hash << "\n";
+}
+
+void runExercice2() {
+   
+    cout << "\n==============================\n";
+    cout << "EXERCICE 2 : Proof of Work (PoW)\n";
+    cout << "==============================\n";
+
+    vector<vector<string>> allTransactions = {
+        {"Alice->Bob:3", "Charlie->Dave:2", "Eve->Frank:1"},
+        {"Meriem->Sara:4", "Youssef->Nadia:2"},
+        {"Omar->Zineb:5", "Rania->Laila:3", "Ali->Hassan:1"}
+    };
+
+    string prevHash = string(64, '0'); // Hash du bloc Genesis
+    int difficulty = 3;
+    int id = 1;
+    long long totalTime = 0;
+
+    for (auto &txs : allTransactions) {
+        string merkle = calculateMerkleRoot(txs);
+        BlockTx b(id, prevHash, TxColumns(), merkle);
+
+        cout << "\n--- Minage du bloc #" << id << " ---\n";
+        auto start = chrono::high_resolution_clock::now();
+        b.mineBlock(difficulty);
+        auto end = chrono::high_resolution_clock::now();
+        long long duration = chrono::duration_cast<chrono::milliseconds>(end - start).count();
+        totalTime += duration;
+
+        printBlockInfo(b);
+        cout << "⏱ Temps minage : " << duration << " ms\n";
+
+        prevHash = b.hash;
+        id++;
+    }
+
+    cout << "\n==============================\n";
+    cout << "Tous les blocs PoW minés avec succès !\n";
+    cout << " Temps total : " << totalTime << " ms\n";
+    cout << "Difficulté utilisée : " << difficulty << "\n";
+    cout << "==============================\n";
+
+    
+}
+
+
+// Exercice 3 : PoW + PoS simplifié
+void runExercice3() {
+    Blockchain myChain({{"Zineb",50},{"Hamza",50},{"Ali",50}});
+    PoSSystem posSystem;
+
+    vector<Transaction> txs1 = {Transaction(1,"Zineb","Merieme",10), Transaction(2,"Hamza","Sara",5)};
+    BlockTx block1(myChain.chain.back().id+1, myChain.chain.back().hash, txs1);
+
+    cout << "\n--- Simulation PoW sur 1 bloc ---\n";
+    long long tPow = simulateSeal(block1,PoWConsensus(3));
+    if(!myChain.addBlock(block1)) cout << "✖ Bloc rejeté : solde insuffisant\n";
+    myChain.printBlock(block1);
+    cout << "Temps minage PoW: " << tPow / 1e6 << " ms\n";
+
+    vector<Transaction> txs2 = {Transaction(3,"Ali","Laila",7)};
+    BlockTx block2(myChain.chain.back().id+1, myChain.chain.back().hash, txs2);
+
+    cout << "\n--- Simulation PoS sur 1 bloc ---\n";
+    long long tPos = simulateSeal(block2,PoSConsensus(posSystem));
+    if(!myChain.addBlock(block2)) cout << "✖ Bloc rejeté : solde insuffisant\n";
+    myChain.printBlock(block2);
+    cout << "Temps validation PoS: " << tPos / 1e3 << " µs\n";
+    // Comparaison
+    cout << "\n===== Comparaison des temps d'exécution =====\n";
+    cout << "PoW: " << tPow << " ns, PoS: " << tPos << " ns\n";
+    cout << "Le plus rapide: " << (tPos < tPow? "PoS" : "PoW") << endl;
+
+
+    cout << "\nVérification blockchain exercice 3: " << (myChain.isValid()?"✔ Valide\n":"✖ Invalide\n");
+    cout << "Validateurs PoS: " << (posSystem.verifyValidators(myChain.chain.snapshot()).empty()?"✔ Vérifiés\n":"✖ Incorrects\n");
+}
+
+
+// Exercice 4 : Blockchain complète + comparaison PoW/PoS
+void runExercice4() {
+    Blockchain myChain({{"Zineb",50},{"Hamza",50},{"Yassine",50},{"Mouad",50},{"Ali",50},{"Sara",50},{"Ahmed",50},{"Nora",50}});
+    PoSSystem posSystem;
+    vector<vector<Transaction>> listTxs = {
+        {Transaction(1,"Zineb","Merieme",10),Transaction(2,"Hamza","Sara",5)},
+        {Transaction(3,"Yassine","Hajar",2),Transaction(4,"Mouad","Zineb",1)},
+        {Transaction(5,"Ali","Laila",7),Transaction(6,"Sara","Hamza",3)},
+        {Transaction(7,"Ahmed","Omar",8),Transaction(8,"Nora","Yassine",2)}
+    };
+
+    int difficulty=3;
+    const size_t txsPerBlock=2;
+
+    // Les transactions passent par le mempool ; les frais (arbitraires ici) fixent l'ordre d'inclusion.
+    // Le mempool consulte l'index de la chaîne : une transaction déjà incluse est refusée à la soumission.
+    Mempool mempool(myChain.seen);
+    // offset : décalage des ids, pour soumettre les mêmes virements comme transactions nouvelles ;
+    // renvoie le nombre de transactions refusées
+    auto submitAll=[&](int offset){
+        int refused=0;
+        for(auto& txs:listTxs) for(auto& tx:txs){
+            Transaction t=tx; t.id+=offset;
+            if(!mempool.submit(t,toAmount(0.01*(tx.id%3)))) ++refused;
+        }
+        return refused;
+    };
+    const int nTxs=(int)(listTxs.size()*txsPerBlock);
+
+    // Préparation, minage et ajout/affichage se recouvrent (voir BlockPipeline)
+    BlockPipeline pipeline(myChain,mempool,txsPerBlock);
+
+    cout<<"\n===== Ajout blocs PoW =====\n";
+    submitAll(0);
+    // En mode silencieux, rien n'est affiché pendant le minage : les blocs le sont après les mesures
+    bool quiet=quietMode();
+    PipelineStats powStats=pipeline.run(listTxs.size(),PoWConsensus(difficulty),[&](const BlockTx& b,long long t){
+        if(quiet) return;
+        cout<<"Bloc PoW ajouté:\n"; myChain.printBlock(b); cout<<"Temps minage PoW: "<<t/1e6<<" ms\n";
+    });
+    if(powStats.droppedTxs) cout<<"✖ "<<powStats.droppedTxs<<" transaction(s) PoW écartée(s) : solde insuffisant\n";
+    if(!powStats.ok()) cout<<"✖ Bloc PoW "<<powStats.rejectedBlock<<" refusé par la chaîne : production arrêtée\n";
+
+    // Mêmes virements, ids nouveaux : les transactions du PoW rejouées telles quelles seraient refusées
+    cout<<"\n===== Ajout blocs PoS =====\n";
+    submitAll(nTxs);
+    PipelineStats posStats=pipeline.run(listTxs.size(),PoSConsensus(posSystem),[&](const BlockTx& b,long long t){
+        if(quiet) return;
+        cout<<"Bloc PoS ajouté:\n"; myChain.printBlock(b); cout<<"Temps validation PoS: "<<t/1e3<<" µs\n";
+    });
+    if(posStats.droppedTxs) cout<<"✖ "<<posStats.droppedTxs<<" transaction(s) PoS écartée(s) : solde insuffisant\n";
+    if(!posStats.ok()) cout<<"✖ Bloc PoS "<<posStats.rejectedBlock<<" refusé par la chaîne : production arrêtée\n";
+
+    cout<<"\n===== Rejeu des transactions PoW =====\n";
+    int refused=submitAll(0);
+    PipelineStats replay=pipeline.run(listTxs.size(),PoSConsensus(posSystem));
+    cout<<refused<<" transaction(s) rejouée(s) refusée(s) par le mempool, "<<replay.duplicateTxs<<" écartée(s) à l'assemblage, "
+        <<replay.blocks<<" bloc(s) ajouté(s)\n";
+
+    if(quiet){
+        cout<<"\n===== Blocs ajoutés (PoW puis PoS) =====\n";
+        for(size_t i=1;i<myChain.chain.size();++i) myChain.printBlock(myChain.chain[i]);
+    }
+
+    cout<<"\n===== Vérification Blockchain =====\n";
+    cout<<(myChain.isValid()?"✔ Blockchain valide\n":"✖ Blockchain invalide\n");
+    cout<<(posSystem.verifyValidators(myChain.chain.snapshot()).empty()?"✔ Validateurs PoS vérifiés\n":"✖ Validateurs PoS incorrects\n");
+
+    // Latences en µs (horloge monotone, résolution ns), percentiles tirés des histogrammes
+    cout<<"\n===== Analyse Comparative =====\n";
+    cout<<left<<padLabel("Critère",28)<<setw(15)<<"PoW"<<setw(15)<<"PoS"<<endl;
+    cout<<string(58,'-')<<endl;
+    cout<<fixed<<setprecision(2);
+    auto row=[&](const string& label,auto field){ cout<<padLabel(label,28)<<setw(15)<<field(powStats)<<setw(15)<<field(posStats)<<endl; };
+    row("Blocs",[](const PipelineStats& s){ return s.blocks; });
+    row("Latence moy./bloc (µs)",[](const PipelineStats& s){ return s.sealNs.mean()/1e3; });
+    row("Latence p50 (µs)",[](const PipelineStats& s){ return s.sealNs.percentile(0.50)/1e3; });
+    row("Latence p90 (µs)",[](const PipelineStats& s){ return s.sealNs.percentile(0.90)/1e3; });
+    row("Latence p99 (µs)",[](const PipelineStats& s){ return s.sealNs.percentile(0.99)/1e3; });
+    row("Latence max (µs)",[](const PipelineStats& s){ return s.sealNs.max()/1e3; });
+    row("Hashes/bloc (moy.)",[](const PipelineStats& s){ return s.attempts.mean(); });
+    row("Débit (Mhash/s)",[](const PipelineStats& s){ return s.hashRate()/1e6; });
+    row("CPU préparation (ms)",[](const PipelineStats& s){ return s.cpuPrepareMs; });
+    row("CPU scellement (ms)",[](const PipelineStats& s){ return s.cpuSealMs; });
+    row("CPU ajout (ms)",[](const PipelineStats& s){ return s.cpuAppendMs; });
+    row("Attente préparation (µs)",[](const PipelineStats& s){ return s.stallNs/1e3; });
+    auto perBlock=[](const AllocSample& a,size_t blocks){ return blocks?(double)a.count/blocks:0.0; };
+    if(allocStatsAvailable()){
+        row("Allocs/bloc préparation",[&](const PipelineStats& s){ return perBlock(s.allocPrepare,s.blocks); });
+        row("Allocs/bloc scellement",[&](const PipelineStats& s){ return perBlock(s.allocSeal,s.blocks); });
+        row("Allocs/bloc ajout",[&](const PipelineStats& s){ return perBlock(s.allocAppend,s.blocks); });
+    } else cout<<padLabel("Allocs/bloc",28)<<setw(15)<<"n/d"<<setw(15)<<"n/d"<<endl;
+    cout<<padLabel("Facilité implémentation",28)<<setw(15)<<"Complexe"<<setw(15)<<"Simple"<<endl;
+    cout.unsetf(ios::fixed);
+    cout<<setprecision(6);
+    cout<<"\nBloc le plus rapide (p50): "<<(posStats.sealNs.percentile(0.5)<powStats.sealNs.percentile(0.5)?"PoS":"PoW")<<endl;
+
+    cout<<"\n===== Soldes nets des comptes =====\n";
+    vector<Amount> balances=computeBalances(myChain);
+    for(AccountId a=0;a<balances.size();++a) if(balances[a]!=0) cout<<setw(20)<<accounts().name(a)<<formatAmount(balances[a])<<"\n";
+}
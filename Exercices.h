@@ -0,0 +1,10 @@
+// Les quatre exercices de l'atelier (programmes Exercice1..4 et menu de ProgrammeComplet)
+#ifndef EXERCICES_H
+#define EXERCICES_H
+
+void runExercice1(); // Arbre de Merkle
+void runExercice2(); // Proof-of-Work simple
+void runExercice3(); // PoW + PoS simplifié
+void runExercice4(); // Blockchain avec transactions et comparaison PoW/PoS
+
+#endif // EXERCICES_H
@@ -1,368 +1,1161 @@
+#include "BlockchainCore.h"
+#include "Exercices.h"
+
+
+// Démo : snapshots d'état et démarrage rapide
+void runSnapshots() {
+    string dir = (filesystem::temp_directory_path() / "atelier_snapshots").string();
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+
+    const int nBlocks = 2000, txsPerBlock = 200, nAccounts = 1000;
+    vector<pair<string,double>> alloc;
+    for (int i = 0; i < nAccounts; ++i) alloc.push_back({"compte" + to_string(i), 1000});
+    Blockchain myChain(alloc);
+    vector<AccountId> ids;
+    for (auto& a : alloc) ids.push_back(accounts().intern(a.first));
+    PoSSystem posSystem;
 
-#include <iostream>
-#include <vector>
-#include <string>
-#include <sstream>
-#include <iomanip>
-#include <chrono>
-#include <ctime>
-#include <cstdint>
-#include <random>
-
-using namespace std;
-using namespace chrono;
-
-// Fonction de hachage rapide (réutilisée partout)
-
-string fastSHA256(const string& data) {
-    const uint64_t FNV_OFFSET = 1469598103934665603ULL;
-    const uint64_t FNV_PRIME = 1099511628211ULL;
-
-    uint64_t h1 = FNV_OFFSET;
-    uint64_t h2 = FNV_OFFSET ^ 0xCAFEBABEDEADBEEFULL;
+    {
+        ChainStorage storage(dir, 500);
+        storage.append(myChain, myChain.chain[0]);
+        mt19937 rng(42);
+        int txId = 1;
+        for (int i = 0; i < nBlocks; ++i) {
+            TxColumns txs;
+            txs.reserve(txsPerBlock);
+            for (int k = 0; k < txsPerBlock; ++k)
+                txs.push(Transaction(txId++, ids[rng() % nAccounts], ids[rng() % nAccounts], toAmount(1 + rng() % 10)));
+            BlockTx b(myChain.chain.back().id + 1, myChain.chain.back().hash, std::move(txs));
+            b.validatePoS(posSystem.chooseValidator(b.prevHash, b.id));
+            if (myChain.addBlock(b)) storage.append(myChain, b);
+        }
+    }
+    cout << "\n===== Snapshots d'état =====\n";
+    cout << "Blocs écrits : " << myChain.chain.size() << " (snapshot tous les 500 blocs) dans " << dir << "\n";
+
+    ChainStorage storage(dir, 500);
+    Blockchain full, fast;
+    auto t0 = steady_clock::now();
+    storage.restore(full, false);
+    auto t1 = steady_clock::now();
+    storage.restore(fast, true);
+    auto t2 = steady_clock::now();
+
+    auto same = [&](const Blockchain& bc) {
+        if (bc.chain.back().hash != myChain.chain.back().hash || bc.seen.size() != myChain.seen.size()) return false;
+        for (AccountId a = 0; a < accounts().size(); ++a) if (bc.ledger.balance(a) != myChain.ledger.balance(a)) return false;
+        return true;
+    };
+    cout << "Rejeu complet      : " << duration_cast<microseconds>(t1 - t0).count() << " us, " << full.chain.size() << " blocs en mémoire, "
+         << (same(full) ? "état identique" : "état différent !") << "\n";
+    cout << "Snapshot + rejeu   : " << duration_cast<microseconds>(t2 - t1).count() << " us, départ à la hauteur " << fast.chain[0].id << ", "
+         << (same(fast) ? "état identique" : "état différent !") << "\n";
+}
 
-    for (unsigned char c : data) {
-        h1 ^= c;
-        h1 *= FNV_PRIME;
-        h1 ^= (h1 >> 12);
 
-        h2 ^= (uint64_t)c + 0x9e3779b97f4a7c15ULL + (h2 << 6) + (h2 >> 2);
+// Benchmark : sélection pondérée de validateurs (1M validateurs)
+void runValidatorBench() {
+    const size_t nValidators = 1000000, draws = 10000000, linearDraws = 200;
+    mt19937_64 rng(7);
+    vector<pair<string,uint64_t>> vals;
+    vals.reserve(nValidators);
+    uint64_t rest = 0;
+    for (size_t i = 1; i < nValidators; ++i) { uint64_t st = 1 + rng() % (1ULL << 40); vals.push_back({"val" + to_string(i), st}); rest += st; }
+    vals.insert(vals.begin(), {"val0", rest / 9}); // val0 détient 10 % du stake total
+
+    cout << "\n===== Sélection de validateurs : " << nValidators << " validateurs =====\n";
+    auto t0 = steady_clock::now();
+    PoSSystem pos(vals);
+    auto t1 = steady_clock::now();
+    cout << "Construction du PoSSystem (registre) : " << duration_cast<milliseconds>(t1 - t0).count() << " ms\n";
+    SplitMix64 draw(7); // tirages portables
+
+    AliasSampler sampler;
+    vector<uint64_t> stakes;
+    for (auto& v : vals) stakes.push_back(v.second);
+    sampler.build(stakes);
+    size_t hits0 = 0;
+    t0 = steady_clock::now();
+    for (size_t i = 0; i < draws; ++i) hits0 += sampler.sample(draw) == 0;
+    t1 = steady_clock::now();
+    double nsAlias = (double)duration_cast<nanoseconds>(t1 - t0).count() / draws;
+
+    // Ancienne méthode : somme des stakes puis parcours linéaire à chaque tirage
+    size_t sink = 0;
+    t0 = steady_clock::now();
+    for (size_t i = 0; i < linearDraws; ++i) {
+        uint64_t totalStake = 0;
+        for (auto& v : vals) totalStake += v.second;
+        uint64_t rnd = rng() % totalStake;
+        for (size_t k = 0; k < vals.size(); ++k) { if (rnd < vals[k].second) { sink += k; break; } rnd -= vals[k].second; }
     }
+    keepResult(sink);
+    t1 = steady_clock::now();
+    double nsLinear = (double)duration_cast<nanoseconds>(t1 - t0).count() / linearDraws;
+
+    cout << fixed << setprecision(1);
+    cout << "Alias  : " << nsAlias << " ns/tirage (" << draws << " tirages)\n";
+    cout << "Linéaire : " << nsLinear << " ns/tirage (" << linearDraws << " tirages)\n";
+    cout << "Fréquence de val0 : " << setprecision(4) << 100.0 * hits0 / draws << " % (attendu "
+         << 100.0 * vals[0].second / sampler.total() << " %)\n";
+
+    // Ensemble dynamique : une mise à jour de stake entre chaque tirage
+    const size_t updates = 1000000, rebuilds = 10;
+    StakeRegistry registry;
+    t0 = steady_clock::now();
+    for (auto& v : vals) registry.setStake(v.first, v.second);
+    t1 = steady_clock::now();
+    cout << "\nRegistre Fenwick : chargement " << duration_cast<milliseconds>(t1 - t0).count() << " ms\n";
+    hits0 = 0;
+    t0 = steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) {
+        auto& v = vals[1 + rng() % (nValidators - 1)];
+        registry.setStake(v.first, 1 + rng() % (1ULL << 40));
+        hits0 += registry.sample(draw) == vals[0].first;
+    }
+    t1 = steady_clock::now();
+    cout << "Fenwick : " << setprecision(1) << (double)duration_cast<nanoseconds>(t1 - t0).count() / updates << " ns/(mise à jour + tirage)\n";
+    t0 = steady_clock::now();
+    for (size_t i = 0; i < rebuilds; ++i) { stakes[1 + rng() % (nValidators - 1)] = 1 + rng() % (1ULL << 40); sampler.build(stakes); sampler.sample(draw); }
+    t1 = steady_clock::now();
+    cout << "Alias   : " << (double)duration_cast<nanoseconds>(t1 - t0).count() / rebuilds << " ns/(reconstruction + tirage)\n";
+    cout << "Fréquence de val0 (Fenwick) : " << setprecision(4) << 100.0 * hits0 / updates << " % (attendu "
+         << 100.0 * registry.stakeOf("val0") / registry.total() << " %)\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
 
-    std::ostringstream ss;
-    ss << std::hex << std::nouppercase << std::setfill('0')
-       << std::setw(16) << (h1 ^ (h2 >> 7))
-       << std::setw(16) << (h2 ^ (h1 << 3))
-       << std::setw(16) << (~h1)
-       << std::setw(16) << (~h2);
 
-    string out = ss.str();
-    if (out.size() < 64) out.append(64 - out.size(), '0');
-    return out.substr(0, 64);
+// Démo : minage asynchrone annulé à l'arrivée d'un bloc concurrent
+void runAsyncMining() {
+    const int difficulty = 3, rounds = 5;
+    AsyncMiner miner;
+    Blockchain myChain({{"Zineb", 100}, {"Sara", 100}});
+    bool accepted = true;
+    cout << "\n===== Minage asynchrone avec annulation =====\n";
+    for (int r = 0; r < rounds; ++r) {
+        vector<Transaction> txs = {Transaction(100 + r, "Zineb", "Hamza", 1)};
+        BlockTx candidate(myChain.chain.back().id + 1, myChain.chain.back().hash, txs);
+        MiningHandle h = miner.mine(candidate, difficulty);
+        if (h.result.wait_for(milliseconds(20)) == future_status::ready) {
+            MiningResult res = h.result.get();
+            accepted &= myChain.addBlock(res.block);
+            cout << "Bloc #" << res.block.id << " miné avant tout concurrent (" << res.hashes << " hashes)\n";
+            continue;
+        }
+        // Un bloc concurrent de même hauteur arrive (miné ailleurs) : on change de parent
+        BlockTx competitor(candidate.id, candidate.prevHash, vector<Transaction>{Transaction(200 + r, "Sara", "Ali", 1)});
+        competitor.mineBlock(1);
+        accepted &= myChain.addBlock(competitor);
+        auto t0 = steady_clock::now();
+        BlockTx next(myChain.chain.back().id + 1, myChain.chain.back().hash, txs);
+        MiningHandle h2 = miner.restart(h, next, difficulty);
+        MiningResult stale = h.result.get();
+        long long cancelUs = duration_cast<microseconds>(steady_clock::now() - t0).count();
+        MiningResult res = h2.result.get();
+        accepted &= myChain.addBlock(res.block);
+        cout << "Bloc concurrent #" << competitor.id << " reçu : annulation en " << cancelUs << " us, "
+             << stale.hashes << " hashes perdus ; bloc #" << res.block.id << " miné sur le nouveau parent\n";
+    }
+    MiningStats st = miner.stats();
+    cout << "Minages : " << st.jobs << " dont " << st.cancelledJobs << " annulés\n";
+    cout << "Hashes utiles : " << st.usefulHashes << ", perdus : " << st.wastedHashes
+         << " (" << st.wastedMicros / 1000 << " ms sur parent périmé)\n";
+    cout << "Chaîne " << (accepted && myChain.isValid() ? "✔ valide" : "✖ invalide") << " (" << myChain.chain.size() << " blocs)\n";
 }
 
 
-// Exercice 1 : Arbre de Merkle
+// Simulation réseau : comparaison PoW / PoS / hybride sur plusieurs nœuds
+void runNetworkSim() {
+    NetworkConfig cfg;
+    cout << "\n===== Simulation réseau : " << cfg.nodes << " nœuds, latence " << cfg.latencyMs << " ms, "
+         << cfg.bandwidthMbps << " Mbit/s, perte " << cfg.lossRate * 100 << " % =====\n";
+    PoSSystem validators(networkValidators(cfg));
+    NetworkSimulator<PoWConsensus> powSim(cfg, PoWConsensus(cfg.difficulty));
+    NetworkSimulator<PoSConsensus> posSim(cfg, PoSConsensus(validators));
+    NetworkSimulator<HybridConsensus> hybSim(cfg, HybridConsensus(validators, cfg.hybridDifficulty));
+    NetworkReport r[3] = {powSim.run(), posSim.run(), hybSim.run()};
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(28) << "Critère" << setw(15) << "PoW" << setw(15) << "PoS" << setw(15) << "Hybride" << "\n";
+    cout << string(73, '-') << "\n";
+    auto row = [&](const string& label, auto field) {
+        cout << setw(28) << label;
+        for (auto& rep : r) cout << setw(15) << field(rep);
+        cout << "\n";
+    };
+    row("Durée (s)", [](const NetworkReport& x) { return x.seconds; });
+    row("Hauteur atteinte", [](const NetworkReport& x) { return x.height; });
+    row("Blocs produits", [](const NetworkReport& x) { return x.producedBlocks; });
+    row("Taux d'orphelins (%)", [](const NetworkReport& x) { return 100 * x.orphanRate; });
+    row("Débit (blocs/s)", [](const NetworkReport& x) { return x.blocksPerSec; });
+    row("Débit (tx/s)", [](const NetworkReport& x) { return x.txPerSec; });
+    row("Confirmation moy. (ms)", [](const NetworkReport& x) { return x.confirmMeanMs; });
+    row("Confirmation p50 (ms)", [](const NetworkReport& x) { return x.confirmP50Ms; });
+    row("Confirmation max (ms)", [](const NetworkReport& x) { return x.confirmMaxMs; });
+    row("Messages envoyés", [](const NetworkReport& x) { return x.messages; });
+    row("  dont perdus", [](const NetworkReport& x) { return x.dropped; });
+    row("Nœuds d'accord (h-2)", [](const NetworkReport& x) { return x.agreeingNodes; });
+    row("Réorganisations (nœud 0)", [](const NetworkReport& x) { return x.reorgs; });
+    row("  tx remises en attente", [](const NetworkReport& x) { return x.requeuedTxs; });
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6) << right;
+}
 
-class Node {
-public:
-    string hash;
-    Node* left;
-    Node* right;
+// Démo : synchronisation d'une longue chaîne PoS, vérification bloc par bloc puis par lots
+void runBatchVerify() {
+    const size_t nBlocks = 200000, epochLen = 10000, nValidators = 64;
+    mt19937_64 rng(11);
+    StakeHistory history;
+    for (size_t from = 1; from < nBlocks; from += epochLen) {
+        vector<pair<string,uint64_t>> stakes;
+        for (size_t v = 0; v < nValidators; ++v) stakes.push_back({"val" + to_string(v), 1 + rng() % 1000});
+        history.set(from, std::move(stakes));
+    }
 
-    Node(const string& h) : hash(h), left(nullptr), right(nullptr) {}
-};
+    cout << "\n===== Vérification par lots : " << nBlocks << " blocs PoS, " << history.size() << " époques de stake =====\n";
+    vector<BlockTx> blocks;
+    blocks.reserve(nBlocks);
+    blocks.emplace_back(0, "0", TxColumns(), string(64, '0'));
+    for (size_t i = 1; i < nBlocks; ++i) {
+        const string& prev = blocks.back().hash;
+        string root = fastSHA256("txs" + to_string(i));
+        blocks.emplace_back((int)i, prev, TxColumns(), root);
+        blocks.back().validatePoS(history.at(i)->chooseValidator(prev, i));
+    }
+    // Quelques blocs falsifiés : hash, validateur, chaînage
+    blocks[12345].hash[5] ^= 1;
+    blocks[54321].validator = "intrus"; blocks[54321].calculateHash();
+    blocks[150000].prevHash = fastSHA256("fork"); blocks[150000].calculateHash();
+
+    // Référence : un bloc à la fois (recherche d'époque, préimages et hashes individuels)
+    auto t0 = steady_clock::now();
+    size_t badSingle = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        const BlockTx& b = blocks[i];
+        bool ok = fastSHA256(b.headerData()) == b.hash;
+        if (i > 0) ok = ok && b.prevHash == blocks[i - 1].hash && b.validator == history.at(b.id)->chooseValidator(b.prevHash, b.id);
+        badSingle += !ok;
+    }
+    auto t1 = steady_clock::now();
+    double msSingle = duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+
+    t0 = steady_clock::now();
+    BatchVerifyResult one = verifyPoSBatch(blocks, 0, blocks.size(), history, 1);
+    t1 = steady_clock::now();
+    double msBatch1 = duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+
+    t0 = steady_clock::now();
+    BatchVerifyResult all = verifyPoSBatch(blocks, 0, blocks.size(), history);
+    t1 = steady_clock::now();
+    double msBatchN = duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+
+    auto list = [](const vector<size_t>& v) { string s; for (size_t i : v) s += (s.empty() ? "" : ", ") + to_string(i); return s.empty() ? string("-") : s; };
+    cout << "Hash invalide       : " << list(all.badHash) << "\n";
+    cout << "Chaînage rompu      : " << list(all.badLink) << "\n";
+    cout << "Validateur invalide : " << list(all.badValidator) << "\n";
+    cout << "Résultats identiques (1 thread / " << max(1u, thread::hardware_concurrency()) << " threads) : "
+         << (one.badHash == all.badHash && one.badLink == all.badLink && one.badValidator == all.badValidator ? "oui" : "NON") << "\n";
+
+    cout << fixed << setprecision(1);
+    cout << left << setw(28) << "Méthode" << setw(14) << "Temps (ms)" << "Blocs/s\n" << string(56, '-') << "\n";
+    auto row = [&](const string& label, double ms) { cout << setw(28) << label << setw(14) << ms << (ms > 0 ? nBlocks / (ms / 1000) : 0) << "\n"; };
+    row("Bloc par bloc", msSingle);
+    row("Par lots, 1 thread", msBatch1);
+    row("Par lots, tous threads", msBatchN);
+    cout << "(blocs rejetés bloc par bloc : " << badSingle << ")\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6) << right;
+}
 
-class MerkleTree {
-private:
-    vector<Node*> leaves;
-    Node* root;
+// Démo : profil matériel des phases (minage, arbre de Merkle, validation, sélection PoS)
+void runPhaseProfile() {
+    cout << "\n===== Profil matériel des phases =====\n";
+    PhaseProfiler profiler;
+
+    const int difficulty = 3, minedBlocks = 4;
+    uint64_t attempts = 0;
+    for (int i = 0; i < minedBlocks; ++i) {
+        BlockTx b(i + 1, fastSHA256("prev" + to_string(i)), TxColumns(), fastSHA256("root" + to_string(i)));
+        profiler.measure("mineBlock", [&] { b.mineBlock(difficulty); });
+        attempts += b.nonce;
+    }
 
-public:
-    MerkleTree(const vector<string>& transactions) {
-        buildTree(transactions);
+    // Hachage d'en-tête et racine d'un bloc de transactions : temporaires dans l'arène du thread
+    size_t hashed = 0;
+    {
+        BlockTx b(1, fastSHA256("prev"), TxColumns(), fastSHA256("root"));
+        profiler.measure("calculateHash", [&] { for (; hashed < 200000; ++hashed) { ++b.nonce; b.calculateHash(); } });
+    }
+    WorkloadGenerator gen(WorkloadConfig{});
+    TxColumns blockTxs;
+    gen.fill(blockTxs, 4096);
+    string txRoot;
+    profiler.measure("computeTxMerkleRoot", [&] { for (int r = 0; r < 16; ++r) txRoot = computeTxMerkleRoot(blockTxs); });
+
+    const size_t nLeaves = 1 << 16;
+    vector<string> leaves;
+    leaves.reserve(nLeaves);
+    for (size_t i = 0; i < nLeaves; ++i) leaves.push_back("tx" + to_string(i) + "->" + to_string(i * 7919 % nLeaves));
+    string rootTree, rootFlat;
+    profiler.measure("MerkleTree (nœuds)", [&] { MerkleTree tree(leaves); rootTree = tree.getRootHash(); });
+    // Même calcul sur un tableau contigu (les feuilles y sont hachées au préalable, comme dans l'arbre)
+    profiler.measure("Merkle (tableau)", [&] {
+        vector<string> leafHashes;
+        leafHashes.reserve(leaves.size());
+        for (auto& l : leaves) leafHashes.push_back(fastSHA256(l));
+        rootFlat = calculateMerkleRoot(std::move(leafHashes));
+    });
+
+    const size_t nBlocks = 50000;
+    Blockchain bc;
+    bc.chain.reserve(nBlocks);
+    for (size_t i = 1; i < nBlocks; ++i) {
+        BlockTx b((int)i, bc.chain.back().hash, TxColumns(), fastSHA256("txs" + to_string(i)));
+        b.validatePoS("val" + to_string(i % 97));
+        bc.addBlock(b);
+    }
+    bool valid = false;
+    profiler.measure("isValid", [&] { valid = bc.isValid(); });
+
+    vector<pair<string,uint64_t>> stakes;
+    for (int v = 0; v < 1000; ++v) stakes.push_back({"val" + to_string(v), 1 + (uint64_t)v * v % 997});
+    PoSSystem pos(stakes);
+    const size_t draws = 1000000;
+    size_t sink = 0;
+    profiler.measure("Sélection PoS", [&] { for (size_t h = 0; h < draws; ++h) sink += pos.chooseValidator(bc.chain.back().hash, h).size(); keepResult(sink); });
+
+    profiler.print(cout);
+    cout << "(" << minedBlocks << " blocs minés, " << attempts << " hashes ; " << hashed << " en-têtes ; 16 racines de "
+         << blockTxs.size() << " transactions ; " << nLeaves << " feuilles, racines "
+         << (rootTree == rootFlat ? "identiques" : "DIFFÉRENTES") << " ; " << nBlocks << " blocs "
+         << (valid ? "valides" : "invalides") << " ; " << draws << " sélections)\n";
+}
+// Démo : flux synthétique de plusieurs millions de transactions, consommé sans être stocké
+void runWorkload() {
+    WorkloadConfig cfg;
+    cfg.accounts = 100000;
+    const size_t total = 5000000, perBlock = 5000;
+    cout << "\n===== Charge synthétique : " << total << " transactions, " << cfg.accounts << " comptes, Zipf "
+         << cfg.senderSkew << " / " << cfg.receiverSkew << " =====\n";
+
+    // 1. Génération seule, avec la part des comptes les plus actifs
+    WorkloadGenerator gen(cfg);
+    vector<uint32_t> sent(cfg.accounts, 0);
+    // Rang de chaque compte du flux : les identifiants internés ne sont pas forcément consécutifs
+    vector<uint32_t> rankOf(accounts().size(), 0);
+    for (size_t a = 0; a < cfg.accounts; ++a) rankOf[gen.account(a)] = (uint32_t)a;
+    Amount volume = 0;
+    auto t0 = steady_clock::now();
+    for (size_t i = 0; i < total; ++i) { Transaction tx = gen.next(); ++sent[rankOf[tx.sender]]; volume += tx.amount; }
+    double sec = duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e6;
+    sort(sent.begin(), sent.end(), greater<>());
+    uint64_t top10 = 0, top1pct = 0;
+    for (size_t a = 0; a < cfg.accounts / 100; ++a) { top1pct += sent[a]; if (a < 10) top10 += sent[a]; }
+    cout << fixed << setprecision(1);
+    cout << "Génération        : " << total / sec / 1e6 << " M tx/s\n";
+    cout << "Part des 10 premiers émetteurs : " << 100.0 * top10 / total << " %, du 1 % le plus actif : " << 100.0 * top1pct / total << " %\n";
+    cout << "Montant moyen     : " << formatAmount(volume / (Amount)total) << "\n";
+
+    // 2. Même flux (même graine) découpé en blocs et haché directement
+    WorkloadGenerator replay(cfg);
+    TxColumns block;
+    uint64_t check = 0;
+    t0 = steady_clock::now();
+    for (size_t done = 0; done < total; done += perBlock) {
+        block = TxColumns();
+        replay.fill(block, perBlock);
+        check ^= fastHashWords(computeTxMerkleRoot(block)).w[0];
     }
+    sec = duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e6;
+    cout << "Blocs + Merkle    : " << total / perBlock << " blocs, " << total / sec / 1e6 << " M tx/s (empreinte "
+         << hex << check << dec << ")\n";
+
+    // 3. Alimentation d'un mempool puis assemblage d'un bloc
+    Mempool mempool;
+    WorkloadGenerator feeder(cfg);
+    t0 = steady_clock::now();
+    feeder.feed(mempool, 500000);
+    Amount fees = 0;
+    TxColumns tpl = mempool.buildTemplate(perBlock, SIZE_MAX, &fees);
+    sec = duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e6;
+    cout << "Mempool           : 500000 tx soumises et gabarit de " << tpl.size() << " tx en " << sec * 1e3
+         << " ms (frais " << formatAmount(fees) << ")\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
 
-    void buildTree(vector<string> transactions) {
-        if (transactions.empty()) {
-            root = nullptr;
-            return;
+// Démo : export d'une grande chaîne en JSONL et en binaire, comparé à un affichage par flux
+void runExport() {
+    const size_t nBlocks = 1000, perBlock = 1000;
+    WorkloadConfig cfg;
+    WorkloadGenerator gen(cfg);
+    Blockchain bc(gen.genesisAllocations());
+    bc.chain.reserve(nBlocks + 1);
+    for (size_t i = 0; i < nBlocks; ++i) {
+        TxColumns txs;
+        gen.fill(txs, perBlock);
+        BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(txs));
+        bc.addBlock(b);
+    }
+    auto dir = filesystem::temp_directory_path();
+    string jsonPath = (dir / "atelier_chain.jsonl").string(), binPath = (dir / "atelier_chain.bin").string();
+    string streamPath = (dir / "atelier_chain_stream.txt").string();
+    cout << "\n===== Export : " << bc.chain.size() << " blocs, " << nBlocks * perBlock << " transactions =====\n";
+
+    auto timed = [](auto f) { auto t0 = steady_clock::now(); f(); return duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e6; };
+    uint64_t jsonBytes = 0, binBytes = 0, streamBytes = 0;
+    double jsonSec = timed([&] { OutputSink sink(jsonPath); ChainExporter(sink, ChainExporter::JSONL).write(bc); sink.flush(); jsonBytes = sink.written(); });
+    double binSec = timed([&] { OutputSink sink(binPath); ChainExporter(sink, ChainExporter::BINARY).write(bc); sink.flush(); binBytes = sink.written(); });
+    // Référence : le même contenu écrit champ par champ dans un ofstream, comme printBlock auparavant
+    double streamSec = timed([&] {
+        ofstream f(streamPath);
+        for (const auto& b : bc.chain) {
+            f << "Bloc ID: " << b.id << "\n  PrevHash: " << b.prevHash.substr(0, 20) << "...\n  Hash: " << b.hash.substr(0, 20) << "...\n";
+            for (size_t k = 0; k < b.transactions.size(); ++k) f << "    " << b.transactions.get(k).toString() << "\n";
         }
+        f.flush();
+        streamBytes = (uint64_t)f.tellp();
+    });
+
+    cout << fixed << setprecision(1);
+    cout << left << padLabel("Format", 26) << setw(12) << "Mo" << setw(12) << "ms" << "Mo/s\n" << string(60, '-') << "\n";
+    auto row = [&](const string& label, uint64_t bytes, double sec) {
+        cout << padLabel(label, 26) << setw(12) << bytes / 1e6 << setw(12) << sec * 1e3 << bytes / 1e6 / sec << "\n";
+    };
+    row("JSONL (tamponné)", jsonBytes, jsonSec);
+    row("Binaire (tamponné)", binBytes, binSec);
+    row("Texte par ofstream <<", streamBytes, streamSec);
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6) << right;
+
+    // Relecture du binaire par le magasin de blocs
+    BlockStore store(binPath);
+    BlockTx b;
+    uint64_t offset = 0, next = 0;
+    size_t read = 0;
+    bool same = true;
+    while (store.readAt(offset, b, &next)) { same &= b.hash == bc.chain[read].hash && b.transactions.size() == bc.chain[read].transactions.size(); ++read; offset = next; }
+    cout << "Relecture binaire : " << read << " blocs, " << (same && read == bc.chain.size() ? "identiques" : "DIFFÉRENTS") << "\n";
+    cout << "Fichiers : " << jsonPath << ", " << binPath << "\n";
+    filesystem::remove(streamPath);
+}
 
-        for (const auto& tx : transactions)
-            leaves.push_back(new Node(fastSHA256(tx)));
-
-        vector<Node*> currentLevel = leaves;
-
-        while (currentLevel.size() > 1) {
-            vector<Node*> newLevel;
-
-            for (size_t i = 0; i < currentLevel.size(); i += 2) {
-                if (i + 1 == currentLevel.size()) currentLevel.push_back(currentLevel[i]);
-
-                string combined = currentLevel[i]->hash + currentLevel[i + 1]->hash;
-                Node* parent = new Node(fastSHA256(combined));
-                parent->left = currentLevel[i];
-                parent->right = currentLevel[i + 1];
-                newLevel.push_back(parent);
-            }
-            currentLevel = newLevel;
+// Démo : chaîne légère (en-têtes seuls) face à la chaîne complète, corps relus à la demande
+void runLightChain() {
+    const size_t nBlocks = 20000, perBlock = 100, fetches = 1000;
+    string dir = (filesystem::temp_directory_path() / "atelier_light").string();
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+    string path = (filesystem::path(dir) / "blocks.dat").string();
+
+    WorkloadGenerator gen(WorkloadConfig{});
+    Blockchain bc(gen.genesisAllocations());
+    PoSSystem pos;
+    {
+        BlockStore store(path);
+        store.append(bc.chain[0]);
+        bc.chain.reserve(nBlocks + 1);
+        for (size_t i = 0; i < nBlocks; ++i) {
+            TxColumns txs;
+            gen.fill(txs, perBlock);
+            BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(txs));
+            b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+            if (bc.addBlock(b)) store.append(b);
         }
-        root = currentLevel[0];
     }
-
-    string getRootHash() const {
-        return root ? root->hash : "";
+    // Mémoire de la chaîne complète : objets BlockTx, chaînes hors SSO et colonnes de transactions
+    size_t fullBytes = bc.chain.capacity() * sizeof(BlockTx);
+    for (auto& b : bc.chain) {
+        for (const string* str : {&b.prevHash, &b.merkleRoot, &b.validator, &b.hash}) if (str->capacity() > 15) fullBytes += str->capacity() + 1;
+        fullBytes += b.transactions.memoryBytes();
     }
-
-    void printTreeHorizontal(Node* node, int space = 0, int levelSpace = 6) const {
-        if (!node) return;
-        space += levelSpace;
-        printTreeHorizontal(node->right, space);
-        cout << endl;
-        for (int i = levelSpace; i < space; i++) cout << " ";
-        cout << node->hash.substr(0,6) << endl;
-        printTreeHorizontal(node->left, space);
+    cout << "\n===== Chaîne légère : " << bc.chain.size() << " blocs de " << perBlock << " transactions =====\n";
+
+    auto timed = [](auto f) { auto t0 = steady_clock::now(); f(); return duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e3; };
+    BlockStore store(path);
+    size_t fullRead = 0;
+    double msFull = timed([&] {
+        BlockTx b;
+        uint64_t offset = 0, next = 0;
+        while (store.readAt(offset, b, &next)) { ++fullRead; offset = next; }
+    });
+    LightChain light(store);
+    size_t synced = 0, firstBad = 0;
+    double msSync = timed([&] { synced = light.sync(); });
+    double msVerify = timed([&] { firstBad = light.verifyHeaders(PoSConsensus(pos)); });
+
+    SplitMix64 rng(7);
+    size_t fetchedOk = 0;
+    BlockTx body;
+    double msFetch = timed([&] {
+        for (size_t k = 0; k < fetches; ++k) {
+            size_t i = 1 + rng.below(light.size() - 1);
+            fetchedOk += light.fetchBody(i, body) && body.hash == bc.chain[i].hash && body.transactions.size() == bc.chain[i].transactions.size();
+        }
+    });
+
+    cout << fixed << setprecision(1);
+    cout << padLabel("Mémoire chaîne complète", 30) << fullBytes / 1e6 << " Mo (" << fullBytes / bc.chain.size() << " octets/bloc)\n";
+    cout << padLabel("Mémoire chaîne légère", 30) << light.memoryBytes() / 1e6 << " Mo (" << sizeof(LightChain::Header) << " octets/en-tête)\n";
+    cout << padLabel("Lecture complète", 30) << msFull << " ms (" << fullRead << " blocs)\n";
+    cout << padLabel("Synchronisation des en-têtes", 30) << msSync << " ms (" << synced << " en-têtes)\n";
+    cout << padLabel("Vérification PoS des en-têtes", 30) << msVerify << " ms : " << (firstBad == light.size() ? "valides" : "invalide à " + to_string(firstBad)) << "\n";
+    cout << padLabel("Corps à la demande", 30) << setprecision(2) << msFetch * 1e3 / fetches << " µs/bloc (" << fetchedOk << "/" << fetches << " vérifiés)\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+
+    // Corps altéré dans une copie du magasin : l'en-tête reste valide, la racine Merkle ne l'est plus
+    string tampered = (filesystem::path(dir) / "blocks-altere.dat").string();
+    filesystem::copy_file(path, tampered, filesystem::copy_options::overwrite_existing);
+    size_t victim = light.size() / 2;
+    {
+        fstream f(tampered, ios::in | ios::out | ios::binary);
+        f.seekp(light.bodyOffset(victim + 1) - 1); // octet de poids fort du dernier montant du bloc
+        f.put('\x01');
     }
+    BlockStore altered(tampered);
+    LightChain check(altered);
+    check.sync();
+    cout << "Magasin altéré : " << check.size() << " en-têtes synchronisés, corps du bloc " << victim << " "
+         << (check.fetchBody(victim, body) ? "ACCEPTÉ" : "refusé (racine Merkle)") << "\n";
+}
 
-    void display() const {
-        cout << "\n===== Structure de l’Arbre de Merkle =====\n";
-        printTreeHorizontal(root);
+// Démo : index des adresses (historique, soldes, filtres de Bloom) contre un parcours de la chaîne
+void runAddressIndex() {
+    const size_t nBlocks = 2000, perBlock = 1000, queries = 200;
+    WorkloadConfig cfg;
+    cfg.accounts = 50000;
+    // Crédit de genèse limité par le nombre de comptes : petits montants, pour que l'émetteur le plus
+    // actif reste solvable sur toute la chaîne
+    cfg.amountMedian = 1;
+    WorkloadGenerator gen(cfg);
+    Blockchain bc(gen.genesisAllocations());
+    PoSSystem pos;
+    AddressIndex index(bc);
+    auto timed = [](auto f) { auto t0 = steady_clock::now(); f(); return duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e3; };
+    bc.chain.reserve(nBlocks + 1);
+    double msIndex = 0;
+    for (size_t i = 0; i < nBlocks; ++i) {
+        TxColumns txs;
+        gen.fill(txs, perBlock);
+        BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(txs));
+        b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+        if (bc.addBlock(b)) msIndex += timed([&] { index.append(bc.chain.back()); });
     }
-};
-
-void runExercice1() {
-    vector<string> transactions = {
-        "Zineb-> Merieme : 10 BTC",
-        "Hamza -> Sara : 5 BTC",
-        "Mehdi -> Yassir : 2 BTC",
-        "Sara -> Karim : 1 BTC",
-        "Siham->Salma : 8 BTC",
-        "Reda -> Nora : 12 BTC",
-        "Khouloud -> Soumaia : 6BTC",
-        "Aya -> Zineb: 3 BTC"
-    };
-    cout << "=== Transactions ===\n";
-    for (size_t i=0;i<transactions.size();++i)
-        cout << "Transaction " << i+1 << ": " << transactions[i] << endl;
-
-    MerkleTree merkle(transactions);
-    merkle.display();
-    cout << "\nMerkle Root: " << merkle.getRootHash() << endl;
+    cout << "\n===== Index des adresses : " << bc.chain.size() << " blocs de " << perBlock << " transactions =====\n";
+
+    // Requêtes par nom, sur des comptes tirés uniformément (la plupart peu actifs)
+    SplitMix64 rng(11);
+    vector<string> names;
+    for (size_t q = 0; q < queries; ++q) names.push_back(WorkloadGenerator::accountName(rng.below(cfg.accounts)));
+
+    // Référence : parcours complet de la chaîne en comparant les noms
+    vector<size_t> naiveCount(queries, 0);
+    vector<Amount> naiveBalance(queries, 0);
+    double msNaive = timed([&] {
+        for (size_t q = 0; q < queries; ++q)
+            for (const auto& b : bc.chain) {
+                const TxColumns& t = b.transactions;
+                for (size_t k = 0; k < t.size(); ++k) {
+                    bool out = accounts().name(t.senders[k]) == names[q], in = accounts().name(t.receivers[k]) == names[q];
+                    if (out) naiveBalance[q] -= t.amounts[k];
+                    if (in) naiveBalance[q] += t.amounts[k];
+                    naiveCount[q] += out || in;
+                }
+            }
+    });
+
+    // Parcours guidé : seuls les blocs dont le filtre de Bloom contient le compte sont lus
+    size_t probes = 0, candidates = 0, hits = 0;
+    double msBloom = timed([&] {
+        for (size_t q = 0; q < queries; ++q) {
+            AccountId a;
+            if (!accounts().find(names[q], a)) continue;
+            for (const auto& b : bc.chain) {
+                ++probes;
+                if (!index.mayContain((uint32_t)b.id, a)) continue;
+                ++candidates;
+                const TxColumns& t = b.transactions;
+                bool found = false;
+                for (size_t k = 0; k < t.size() && !found; ++k) found = t.senders[k] == a || t.receivers[k] == a;
+                hits += found;
+            }
+        }
+    });
+
+    // Index : postings et solde courant, puis solde à mi-chaîne et première page d'historique
+    size_t mismatches = 0, paged = 0;
+    uint32_t middle = (uint32_t)(bc.chain.size() / 2);
+    double msQuery = timed([&] {
+        for (size_t q = 0; q < queries; ++q) {
+            AccountId a;
+            if (!accounts().find(names[q], a)) { mismatches += naiveCount[q] != 0; continue; }
+            mismatches += index.postings(a).size() != naiveCount[q] || index.balance(a) != naiveBalance[q];
+            auto page = index.history(a, middle, 20);
+            paged += page.second - page.first;
+            mismatches += index.balanceAt(a, middle - 1) != (page.first == index.postings(a).data() ? 0 : (page.first - 1)->balanceAfter);
+        }
+    });
+    vector<Amount> reference = computeBalances(bc);
+    for (AccountId a = 0; a < reference.size(); ++a) mismatches += index.balance(a) != reference[a];
+
+    cout << fixed << setprecision(1);
+    cout << padLabel("Indexation", 30) << msIndex << " ms (" << setprecision(2) << msIndex * 1e3 / nBlocks << " µs/bloc)\n" << setprecision(1);
+    cout << padLabel("Mémoire de l'index", 30) << index.memoryBytes() / 1e6 << " Mo (" << index.transactions() << " transactions)\n";
+    cout << padLabel("Parcours par noms", 30) << msNaive * 1e3 / queries << " µs/requête\n";
+    cout << padLabel("Parcours guidé (Bloom)", 30) << msBloom * 1e3 / queries << " µs/requête (" << candidates << " blocs candidats, "
+         << setprecision(2) << (probes > hits ? 100.0 * (candidates - hits) / (probes - hits) : 0.0) << " % de faux positifs)\n";
+    cout << padLabel("Index (postings, soldes)", 30) << setprecision(2) << msQuery * 1e3 / queries << " µs/requête (" << paged << " postings paginés)\n";
+    cout << "Accord avec le parcours et computeBalances : " << (mismatches == 0 ? "oui" : to_string(mismatches) + " écarts") << "\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
 }
 
-
-// Exercice 2 : PoW simple
-string calculateMerkleRoot(vector<string> txs) {
-    if (txs.empty()) return string(64,'0');
-    while (txs.size() > 1) {
-        vector<string> next;
-        next.reserve((txs.size()+1)/2);
-        for (size_t i=0;i<txs.size();i+=2) {
-            string left = txs[i];
-            string right = (i+1<txs.size()?txs[i+1]:left);
-            next.push_back(fastSHA256(left+right));
+// Démo : index des transactions vues (débit d'ingestion, rejeux refusés, index sauvegardé dans les snapshots)
+void runSeenIndex() {
+    const size_t nTxs = 4000000, perBlock = 1000;
+    cout << "\n===== Index des transactions vues : " << nTxs << " transactions =====\n";
+    WorkloadConfig cfg;
+    cfg.accounts = 100000;
+    WorkloadGenerator gen(cfg);
+    TxColumns txs;
+    gen.fill(txs, nTxs);
+    TxColumns fresh; // transactions jamais insérées : recherches négatives
+    gen.fill(fresh, nTxs);
+    vector<uint64_t> d(nTxs), other(nTxs);
+    auto timed = [](auto f) { auto t0 = steady_clock::now(); f(); return duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e3; };
+    double msDigest = timed([&] { SeenTxIndex::digests(txs, d.data()); });
+    SeenTxIndex::digests(fresh, other.data());
+
+    SeenTxIndex seen;
+    double msInsert = timed([&] { for (size_t k = 0; k < nTxs; k += perBlock) seen.insert(d.data() + k, min(perBlock, nTxs - k)); });
+    vector<char> dup(nTxs, 0);
+    double msHit = timed([&] { seen.mark(d.data(), nTxs, dup.data()); });
+    size_t hits = count(dup.begin(), dup.end(), 1);
+    fill(dup.begin(), dup.end(), 0);
+    double msMiss = timed([&] { seen.mark(other.data(), nTxs, dup.data()); });
+    size_t falseHits = count(dup.begin(), dup.end(), 1);
+    // Même table sans filtre : référence std::unordered_set
+    unordered_set<uint64_t> plain;
+    double msPlain = timed([&] { plain.reserve(nTxs); for (uint64_t x : d) plain.insert(x); });
+    size_t plainMiss = 0;
+    double msPlainMiss = timed([&] { for (uint64_t x : other) plainMiss += plain.count(x); });
+
+    auto rate = [&](double ms) { return nTxs / ms / 1e3; };
+    cout << fixed << setprecision(1);
+    cout << padLabel("Empreintes", 30) << rate(msDigest) << " M tx/s\n";
+    cout << padLabel("Insertion (par blocs)", 30) << rate(msInsert) << " M tx/s (" << seen.size() << " empreintes, "
+         << seen.memoryBytes() / 1e6 << " Mo)\n";
+    cout << padLabel("Recherche, présentes", 30) << rate(msHit) << " M tx/s (" << hits << " trouvées)\n";
+    cout << padLabel("Recherche, absentes", 30) << rate(msMiss) << " M tx/s (" << falseHits << " collisions)\n";
+    cout << padLabel("unordered_set insertion", 30) << rate(msPlain) << " M tx/s\n";
+    cout << padLabel("unordered_set absentes", 30) << rate(msPlainMiss) << " M tx/s (" << plainMiss << " collisions)\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+
+    // Rejeu d'un bloc déjà inclus, puis restauration depuis un snapshot : le rejeu reste refusé
+    string dir = (filesystem::temp_directory_path() / "atelier_seen").string();
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+    WorkloadGenerator small(WorkloadConfig{});
+    Blockchain bc(small.genesisAllocations());
+    PoSSystem pos;
+    {
+        ChainStorage storage(dir, 50);
+        storage.append(bc, bc.chain[0]);
+        for (int i = 0; i < 120; ++i) {
+            TxColumns t;
+            small.fill(t, 100);
+            BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(t));
+            b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+            if (bc.addBlock(b)) storage.append(bc, b);
         }
-        txs.swap(next);
     }
-    return txs.front();
+    auto replayOf = [&](const Blockchain& chain, size_t height) {
+        BlockTx b(chain.chain.back().id + 1, chain.chain.back().hash, bc.chain[height].transactions);
+        b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+        return b;
+    };
+    BlockTx again = replayOf(bc, 10);
+    cout << "Rejeu du bloc 10 : " << bc.seen.findDuplicates(again.transactions) << " transactions déjà vues, bloc "
+         << (bc.addBlock(again) ? "ACCEPTÉ" : "refusé") << "\n";
+    Blockchain restored;
+    ChainStorage storage(dir, 50);
+    storage.restore(restored, true);
+    BlockTx later = replayOf(restored, 10);
+    cout << "Après restauration (départ à la hauteur " << restored.chain[0].id << ", " << restored.seen.size() << " empreintes) : bloc "
+         << (restored.addBlock(later) ? "ACCEPTÉ" : "refusé") << "\n";
 }
 
-class Block {
-public:
-    int id;
-    time_t timestamp;
-    string prevHash;
-    string merkleRoot;
-    uint64_t nonce;
-    string hash;
-
-    Block(int id_, const string& prevHash_, const string& merkleRoot_)
-        : id(id_), timestamp(time(nullptr)), prevHash(prevHash_), merkleRoot(merkleRoot_), nonce(0) { calculateHash(); }
-
-    void calculateHash() { hash = fastSHA256(to_string(id)+to_string(timestamp)+prevHash+merkleRoot+to_string(nonce)); }
-
-    void mineBlock(int difficulty) {
-        string target(difficulty,'0');
-        do { ++nonce; calculateHash(); } while(hash.compare(0,difficulty,target)!=0);
+// Démo : lecteurs concurrents (explorateurs) pendant que le pipeline ajoute des blocs
+void runConcurrentReads() {
+    const size_t nBlocks = 4000, perBlock = 200;
+    const unsigned readers = max(2u, thread::hardware_concurrency() > 2 ? thread::hardware_concurrency() - 2 : 2u);
+    PoSSystem pos;
+    // Même production sans puis avec lecteurs : l'écart mesure la gêne causée au producteur
+    auto scenario = [&](unsigned nReaders, uint64_t& lookups, uint64_t& scans, uint64_t& broken) {
+        WorkloadGenerator gen(WorkloadConfig{});
+        Blockchain bc(gen.genesisAllocations());
+        Mempool mempool;
+        gen.feed(mempool, nBlocks * perBlock);
+        atomic<bool> done{false};
+        atomic<uint64_t> nLookups{0}, nScans{0}, nBroken{0};
+        vector<thread> pool;
+        for (unsigned r = 0; r < nReaders; ++r) pool.emplace_back([&, r] {
+            Tracer::nameThread("lecteur");
+            SplitMix64 rng(r + 1);
+            uint64_t local = 0, localScans = 0, bad = 0;
+            while (!done.load(memory_order_relaxed)) {
+                auto view = bc.chain.snapshot();
+                if (r == 0) {
+                    // Explorateur : parcours complet de la vue (chaînage et hauteurs)
+                    for (size_t i = 1; i < view.size(); ++i) bad += view[i].prevHash != view[i - 1].hash || view[i].id != (int)i;
+                    localScans += view.size();
+                } else {
+                    // Recherches par hauteur dans la vue figée
+                    for (int k = 0; k < 256; ++k) { size_t h = rng.below(view.size()); bad += view[h].id != (int)h; }
+                    local += 256;
+                }
+            }
+            nLookups += local; nScans += localScans; nBroken += bad;
+        });
+        BlockPipeline pipeline(bc, mempool, perBlock);
+        PipelineStats st = pipeline.run(nBlocks, PoSConsensus(pos));
+        done = true;
+        for (auto& th : pool) th.join();
+        lookups = nLookups; scans = nScans; broken = nBroken;
+        return st;
+    };
+    uint64_t lookups, scans, broken;
+    scenario(0, lookups, scans, broken); // chauffe
+    PipelineStats alone = scenario(0, lookups, scans, broken);
+    PipelineStats shared = scenario(readers, lookups, scans, broken);
+
+    auto perSec = [](double n, long long ns) { return ns ? n * 1e9 / ns : 0.0; };
+    cout << "\n===== Lecture concurrente : " << nBlocks << " blocs de " << perBlock << " transactions, " << readers << " lecteurs, "
+         << thread::hardware_concurrency() << " cœur(s) =====\n";
+    cout << fixed << setprecision(0);
+    cout << padLabel("Production seule", 30) << perSec(alone.blocks, alone.totalNs) << " blocs/s\n";
+    cout << padLabel("Production + lecteurs", 30) << perSec(shared.blocks, shared.totalNs) << " blocs/s\n";
+    cout << padLabel("Recherches par hauteur", 30) << perSec(lookups, shared.totalNs) / 1e6 << " M/s\n" << setprecision(1);
+    cout << padLabel("Parcours complets", 30) << perSec(scans, shared.totalNs) / 1e6 << " M blocs lus/s\n";
+    cout << "Incohérences vues par les lecteurs : " << broken << "\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+
+    // Un snapshot survit à clear : la génération détachée n'est libérée qu'après lui
+    Blockchain bc;
+    string tip = bc.chain.back().hash;
+    size_t pendingHeld, pendingAfter;
+    {
+        auto held = bc.chain.snapshot();
+        bc.chain.clear();
+        pendingHeld = Epochs::collect();
+        cout << "Après clear : chaîne vide (" << bc.chain.size() << " blocs), snapshot encore lisible ("
+             << (held.back().hash == tip ? "pointe intacte" : "POINTE ALTÉRÉE") << ")\n";
     }
-};
-
-void printBlockInfo(const Block& b) {
-    cout << "Bloc ID: " << b.id << "\n";
-    cout << "  Timestamp  : " << b.timestamp << "\n";
-    cout << "  PrevHash   : " << b.prevHash.substr(0,20) << "...\n";
-    cout << "  MerkleRoot : " << b.merkleRoot.substr(0,20) << "...\n";
-    cout << "  Nonce      : " << b.nonce << "\n";
-    cout << "  Hash       : " << b.hash << "\n";
+    pendingAfter = Epochs::collect();
+    cout << "Générations en attente de libération : " << pendingHeld << " avec le snapshot, " << pendingAfter << " après\n";
 }
 
-void runExercice2() {
-   
-    cout << "\n==============================\n";
-    cout << "EXERCICE 2 : Proof of Work (PoW)\n";
-    cout << "==============================\n";
+// Démo : trace chronologique de la production de blocs (Merkle, minage, registre parallèle,
+// sélection PoS, vérification par lots, affichage), à ouvrir dans Perfetto ou about:tracing
+void runTrace() {
+    cout << "\n===== Trace chronologique (Chrome trace-event) =====\n";
+    const unsigned threads = max(2u, thread::hardware_concurrency());
+    PoSSystem pos;
+    WorkloadConfig cfg;
+    cfg.accounts = 50000;
+    // Même scénario exécuté sans puis avec traces : l'écart mesure le coût de l'enregistrement
+    auto scenario = [&](bool show) {
+        auto t0 = steady_clock::now();
+        WorkloadGenerator gen(cfg);
+        Blockchain bc(gen.genesisAllocations());
+        Mempool mempool;
+        gen.feed(mempool, 8 * 20000);
+        // Blocs de 20 000 transactions : le registre les applique en vagues parallèles
+        BlockPipeline big(bc, mempool, 20000, 4, threads);
+        big.run(4, PoWConsensus(2));
+        big.run(4, PoSConsensus(pos));
+
+        gen.feed(mempool, 12);
+        BlockPipeline small(bc, mempool, 4);
+        small.run(3, HybridConsensus(pos, 2), [&](const BlockTx& b, long long) { if (show && !quietMode()) bc.printBlock(b); });
+
+        StakeHistory history;
+        history.set(1, pos.validators());
+        vector<BlockTx> blocks;
+        blocks.reserve(50001);
+        blocks.emplace_back(0, "0", TxColumns(), string(64, '0'));
+        for (size_t i = 1; i <= 50000; ++i) {
+            blocks.emplace_back((int)i, blocks.back().hash, TxColumns(), fastSHA256("txs" + to_string(i)));
+            blocks.back().validatePoS(pos.chooseValidator(blocks[i - 1].hash, i));
+        }
+        bool ok = verifyPoSBatch(blocks, 0, blocks.size(), history, threads).ok();
 
-    vector<vector<string>> allTransactions = {
-        {"Alice->Bob:3", "Charlie->Dave:2", "Eve->Frank:1"},
-        {"Meriem->Sara:4", "Youssef->Nadia:2"},
-        {"Omar->Zineb:5", "Rania->Laila:3", "Ali->Hassan:1"}
+        AsyncMiner miner(threads);
+        for (int i = 0; i < 3; ++i) miner.mine(BlockTx(i + 1, bc.chain.back().hash, TxColumns(), fastSHA256("m" + to_string(i))), 3).result.get();
+        return make_pair(duration_cast<microseconds>(steady_clock::now() - t0).count() / 1e3, ok && bc.isValid());
     };
 
-    string prevHash = string(64, '0'); // Hash du bloc Genesis
-    int difficulty = 3;
-    int id = 1;
-    long long totalTime = 0;
-
-    for (auto &txs : allTransactions) {
-        string merkle = calculateMerkleRoot(txs);
-        Block b(id, prevHash, merkle);
-
-        cout << "\n--- Minage du bloc #" << id << " ---\n";
-        auto start = chrono::high_resolution_clock::now();
-        b.mineBlock(difficulty);
-        auto end = chrono::high_resolution_clock::now();
-        long long duration = chrono::duration_cast<chrono::milliseconds>(end - start).count();
-        totalTime += duration;
-
-        printBlockInfo(b);
-        cout << "⏱ Temps minage : " << duration << " ms\n";
-
-        prevHash = b.hash;
-        id++;
-    }
-
-    cout << "\n==============================\n";
-    cout << "Tous les blocs PoW minés avec succès !\n";
-    cout << " Temps total : " << totalTime << " ms\n";
-    cout << "Difficulté utilisée : " << difficulty << "\n";
-    cout << "==============================\n";
-
-    
+    scenario(false); // mise en route : comptes internés, caches chauds
+    auto off = scenario(false);
+    Tracer::instance().start();
+    auto on = scenario(true);
+    Tracer::instance().stop();
+    string path = (filesystem::temp_directory_path() / "atelier_trace.json").string();
+    size_t events = Tracer::instance().writeFile(path);
+
+    cout << fixed << setprecision(1);
+    cout << padLabel("Sans traces", 22) << off.first << " ms\n";
+    cout << padLabel("Avec traces", 22) << on.first << " ms\n";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    cout << "Chaîne et lots " << (off.second && on.second ? "valides" : "INVALIDES") << " ; " << events << " intervalles, "
+         << Tracer::instance().dropped() << " écrasés\n";
+    cout << "Fichier : " << path << " (ui.perfetto.dev ou chrome://tracing)\n";
 }
 
-// Classes communes pour ex 3 et 4
 
-class Transaction {
-public:
-    int id;
-    string sender;
-    string receiver;
-    double amount;
-    Transaction(int i,string s,string r,double a):id(i),sender(s),receiver(r),amount(a){}
-    string toString() const { stringstream ss; ss<<id<<":"<<sender<<"->"<<receiver<<":"<<amount; return ss.str(); }
+// ===================== Mode non interactif =====================
+// ProgrammeComplet --scenario chain --blocks 100 --txs 500 --consensus pos --format json
+// Sans argument, le menu interactif habituel est affiché.
+
+struct BatchOptions {
+    string scenario = "chain";   // chain | merkle | verify | network | light
+    string consensus = "pow";    // pow | pos | hybrid
+    string format = "json";      // json | csv | text
+    size_t blocks = 20;
+    size_t txsPerBlock = 200;
+    int difficulty = 3;
+    unsigned threads = 0;        // 0 : tous les cœurs
+    uint64_t seed = 1;
+    size_t accounts = 10000;     // population de la charge synthétique
+    double zipf = 1.1;           // asymétrie des émetteurs (0 = uniforme)
+    string exportPath;           // chain : export de la chaîne (.bin binaire, sinon JSONL)
+    string tracePath;            // trace chronologique (Chrome trace-event) du scénario
 };
 
-class BlockTx {
-public:
-    int id;
-    time_t timestamp;
-    string prevHash;
-    string merkleRoot;
-    uint64_t nonce;
-    string validator;
-    string hash;
-    vector<Transaction> transactions;
-
-    BlockTx(int i,string prev,const vector<Transaction>& txs)
-        : id(i), timestamp(time(nullptr)), prevHash(prev), transactions(txs), nonce(0), validator("") {
-        vector<string> txsStr;
-        for(auto &tx: transactions) txsStr.push_back(tx.toString());
-        merkleRoot = calculateMerkleRoot(txsStr);
-        calculateHash();
-    }
+void printBatchUsage(ostream& out) {
+    out << "Usage : ProgrammeComplet [options]\n"
+           "  --scenario chain|merkle|verify|network|light  (défaut chain)\n"
+           "  --consensus pow|pos|hybrid               (défaut pow)\n"
+           "  --blocks N        nombre de blocs          (défaut 20)\n"
+           "  --txs N           transactions par bloc    (défaut 200)\n"
+           "  --difficulty D    zéros en tête (PoW)      (défaut 3)\n"
+           "  --threads T       0 = tous les cœurs       (défaut 0 ; network : un thread par nœud)\n"
+           "  --seed S          graine des données       (défaut 1)\n"
+           "  --accounts N      comptes de la charge     (défaut 10000)\n"
+           "  --zipf S          asymétrie des émetteurs  (défaut 1.1)\n"
+           "  --export FICHIER  chain : export de la chaîne (.bin binaire, sinon JSONL)\n"
+           "  --trace FICHIER   trace chronologique JSON (Perfetto, about:tracing)\n"
+           "  --format json|csv|text                     (défaut json)\n";
+}
 
-    void calculateHash() {
-        string data = to_string(id)+to_string(timestamp)+prevHash+merkleRoot+to_string(nonce)+validator;
-        hash = fastSHA256(data);
+// Lecture des options (--clé valeur ou --clé=valeur) ; invalid_argument en cas d'erreur
+BatchOptions parseBatchOptions(int argc, char** argv) {
+    BatchOptions o;
+    auto number = [](const string& key, const string& v) {
+        uint64_t x = 0;
+        auto r = from_chars(v.data(), v.data() + v.size(), x);
+        if (r.ec != errc() || r.ptr != v.data() + v.size()) throw invalid_argument("valeur invalide pour --" + key + " : " + v);
+        return x;
+    };
+    auto oneOf = [](const string& key, const string& v, initializer_list<const char*> allowed) {
+        for (const char* a : allowed) if (v == a) return v;
+        throw invalid_argument("valeur invalide pour --" + key + " : " + v);
+    };
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i], key, value;
+        if (arg.compare(0, 2, "--") != 0) throw invalid_argument("argument inattendu : " + arg);
+        size_t eq = arg.find('=');
+        if (eq != string::npos) { key = arg.substr(2, eq - 2); value = arg.substr(eq + 1); }
+        else {
+            key = arg.substr(2);
+            if (key == "help") throw invalid_argument("");
+            if (i + 1 >= argc) throw invalid_argument("valeur manquante pour --" + key);
+            value = argv[++i];
+        }
+        if (key == "scenario") o.scenario = oneOf(key, value, {"chain", "merkle", "verify", "network", "light"});
+        else if (key == "consensus") o.consensus = oneOf(key, value, {"pow", "pos", "hybrid"});
+        else if (key == "format") o.format = oneOf(key, value, {"json", "csv", "text"});
+        else if (key == "blocks") o.blocks = number(key, value);
+        else if (key == "txs") o.txsPerBlock = number(key, value);
+        else if (key == "difficulty") o.difficulty = (int)min<uint64_t>(number(key, value), 64);
+        else if (key == "threads") o.threads = (unsigned)number(key, value);
+        else if (key == "seed") o.seed = number(key, value);
+        else if (key == "accounts") o.accounts = number(key, value);
+        else if (key == "export") o.exportPath = value;
+        else if (key == "trace") o.tracePath = value;
+        else if (key == "zipf") {
+            char* end = nullptr;
+            o.zipf = strtod(value.c_str(), &end);
+            if (end != value.c_str() + value.size() || !(o.zipf >= 0)) throw invalid_argument("valeur invalide pour --zipf : " + value);
+        }
+        else throw invalid_argument("option inconnue : --" + key);
     }
+    if (o.blocks == 0 || o.txsPerBlock == 0) throw invalid_argument("--blocks et --txs doivent être positifs");
+    if (o.accounts < 2) throw invalid_argument("--accounts doit valoir au moins 2");
+    return o;
+}
 
-    void mineBlock(int difficulty) { string target(difficulty,'0'); do { ++nonce; calculateHash(); } while(hash.compare(0,difficulty,target)!=0); }
-    void validatePoS(const string& validatorName){validator=validatorName;calculateHash();}
-};
-
-class Blockchain {
+// Résultat d'une exécution : champs ordonnés, écrits en une ligne JSON, en CSV (en-tête + ligne) ou en texte
+class BatchRecord {
 public:
-    vector<BlockTx> chain;
-    Blockchain(){ vector<Transaction> genesisTx = {Transaction(0,"Genesis","Network",0)}; chain.push_back(BlockTx(0,string(64,'0'),genesisTx)); }
-    void addBlock(BlockTx& b){ chain.push_back(b); }
-    bool isValid(){ for(size_t i=1;i<chain.size();++i){ if(chain[i].prevHash!=chain[i-1].hash) return false; BlockTx tmp=chain[i]; tmp.calculateHash(); if(tmp.hash!=chain[i].hash) return false; } return true; }
-    void printBlock(const BlockTx& b){
-        cout<<"Bloc ID: "<<b.id<<"\n  Timestamp: "<<b.timestamp<<"\n  PrevHash: "<<b.prevHash.substr(0,20)<<"...\n  MerkleRoot: "<<b.merkleRoot.substr(0,20)<<"...\n  Nonce: "<<b.nonce<<"\n  Validator: "<<(b.validator.empty()?"N/A":b.validator)<<"\n  Hash: "<<b.hash.substr(0,20)<<"...\n  Transactions:\n";
-        for(auto& tx:b.transactions) cout<<"    "<<tx.toString()<<"\n";
-        cout<<"--------------------------------------\n";
+    void add(const string& key, const string& v) { fields.push_back({key, v, true}); }
+    void add(const string& key, const char* v) { add(key, string(v)); }
+    void add(const string& key, bool v) { fields.push_back({key, v ? "true" : "false", false}); }
+    void add(const string& key, double v) { ostringstream ss; ss << setprecision(9) << v; fields.push_back({key, ss.str(), false}); }
+    template<class Int, class = enable_if_t<is_integral<Int>::value>>
+    void add(const string& key, Int v) { fields.push_back({key, to_string(v), false}); }
+
+    void write(ostream& out, const string& format) const {
+        if (format == "json") {
+            out << "{";
+            for (size_t i = 0; i < fields.size(); ++i) {
+                out << (i ? "," : "") << "\"" << fields[i].key << "\":";
+                if (fields[i].quoted) out << "\"" << jsonEscape(fields[i].value) << "\"";
+                else out << fields[i].value;
+            }
+            out << "}\n";
+        } else if (format == "csv") {
+            for (size_t i = 0; i < fields.size(); ++i) out << (i ? "," : "") << fields[i].key;
+            out << "\n";
+            for (size_t i = 0; i < fields.size(); ++i) out << (i ? "," : "") << fields[i].value;
+            out << "\n";
+        } else {
+            for (auto& f : fields) out << padLabel(f.key, 24) << f.value << "\n";
+        }
     }
-};
 
-class PoSSystem {
-public:
-    vector<pair<string,int>> validators;
-    PoSSystem(){ validators={{"Alice",50},{"Bob",30},{"Charlie",20}}; }
-    string chooseValidator(){ int totalStake=0; for(auto& v:validators) totalStake+=v.second; int rnd=rand()%totalStake; for(auto& v:validators){ if(rnd<v.second) return v.first; rnd-=v.second;} return validators[0].first;}
-    long long simulatePoS(BlockTx& block){ auto start=high_resolution_clock::now(); block.validatePoS(chooseValidator()); auto end=high_resolution_clock::now(); return duration_cast<milliseconds>(end-start).count();}
+private:
+    struct Field { string key, value; bool quoted; };
+    vector<Field> fields;
+
+    static string jsonEscape(const string& v) {
+        string out;
+        for (char c : v) {
+            if (c == '"' || c == '\\') { out += '\\'; out += c; }
+            else if ((unsigned char)c < 0x20) { char buf[8]; snprintf(buf, sizeof buf, "\\u%04x", c); out += buf; }
+            else out += c;
+        }
+        return out;
+    }
 };
 
-long long simulatePoW(BlockTx& block,int difficulty){ auto start=high_resolution_clock::now(); block.mineBlock(difficulty); auto end=high_resolution_clock::now(); return duration_cast<milliseconds>(end-start).count(); }
-
-
-// Exercice 3 : PoW + PoS simplifié
-void runExercice3() {
-    Blockchain myChain;
-    PoSSystem posSystem;
-
-    vector<Transaction> txs1 = {Transaction(1,"Zineb","Merieme",10), Transaction(2,"Hamza","Sara",5)};
-    BlockTx block1(myChain.chain.back().id+1, myChain.chain.back().hash, txs1);
-
-    cout << "\n--- Simulation PoW sur 1 bloc ---\n";
-    long long tPow = simulatePoW(block1,3);
-    myChain.addBlock(block1);
-    myChain.printBlock(block1);
-    cout << "Temps minage PoW: " << tPow << " ms\n";
+WorkloadConfig batchWorkload(const BatchOptions& o) {
+    WorkloadConfig w;
+    w.accounts = o.accounts;
+    w.senderSkew = o.zipf;
+    w.seed = o.seed;
+    return w;
+}
 
-    vector<Transaction> txs2 = {Transaction(3,"Ali","Laila",7)};
-    BlockTx block2(myChain.chain.back().id+1, myChain.chain.back().hash, txs2);
+template<class Consensus>
+void runBatchChain(const BatchOptions& o, const Consensus& consensus, BatchRecord& rec) {
+    WorkloadGenerator workload(batchWorkload(o));
+    Blockchain bc(workload.genesisAllocations());
+    Mempool mempool;
+    workload.feed(mempool, o.blocks * o.txsPerBlock);
+    BlockPipeline pipeline(bc, mempool, o.txsPerBlock, 4, o.threads);
+    PipelineStats st = pipeline.run(o.blocks, consensus);
+    ConsensusChain<Consensus> view(bc, consensus);
+    rec.add("blocks", st.blocks);
+    rec.add("dropped_txs", st.droppedTxs);
+    rec.add("duplicate_txs", st.duplicateTxs);
+    rec.add("rejected_block", st.rejectedBlock);
+    rec.add("total_ms", st.totalNs / 1e6);
+    rec.add("seal_mean_us", st.sealNs.mean() / 1e3);
+    rec.add("seal_p50_us", st.sealNs.percentile(0.50) / 1e3);
+    rec.add("seal_p90_us", st.sealNs.percentile(0.90) / 1e3);
+    rec.add("seal_p99_us", st.sealNs.percentile(0.99) / 1e3);
+    rec.add("seal_max_us", st.sealNs.max() / 1e3);
+    rec.add("hashes", st.hashes);
+    rec.add("hashrate_hps", st.hashRate());
+    rec.add("blocks_per_s", st.totalNs ? st.blocks * 1e9 / st.totalNs : 0.0);
+    rec.add("cpu_prepare_ms", st.cpuPrepareMs);
+    rec.add("cpu_seal_ms", st.cpuSealMs);
+    rec.add("cpu_append_ms", st.cpuAppendMs);
+    // Comptage des allocations absent du build : "n/d" plutôt qu'un zéro trompeur
+    auto perBlock = [&](const string& key, const AllocSample& a) {
+        if (allocStatsAvailable()) rec.add(key, st.blocks ? (double)a.count / st.blocks : 0.0);
+        else rec.add(key, "n/d");
+    };
+    perBlock("allocs_prepare_per_block", st.allocPrepare);
+    perBlock("allocs_seal_per_block", st.allocSeal);
+    perBlock("allocs_append_per_block", st.allocAppend);
+    rec.add("valid", st.ok() && view.isValid());
+    if (!o.exportPath.empty()) {
+        bool binary = filesystem::path(o.exportPath).extension() == ".bin";
+        auto t0 = steady_clock::now();
+        OutputSink sink(o.exportPath);
+        ChainExporter(sink, binary ? ChainExporter::BINARY : ChainExporter::JSONL).write(bc);
+        sink.flush();
+        double sec = duration_cast<nanoseconds>(steady_clock::now() - t0).count() / 1e9;
+        rec.add("export_bytes", sink.written());
+        rec.add("export_mb_per_s", sec > 0 ? sink.written() / 1e6 / sec : 0.0);
+        rec.add("export_ok", sink.ok());
+    }
+}
 
-    cout << "\n--- Simulation PoS sur 1 bloc ---\n";
-    long long tPos = posSystem.simulatePoS(block2);
-    myChain.addBlock(block2);
-    myChain.printBlock(block2);
-    cout << "Temps validation PoS: " << tPos << " ms\n";
-    // Comparaison
-    cout << "\n===== Comparaison des temps d'exécution =====\n";
-    cout << "PoW: " << tPow << " ms, PoS: " << tPos << " ms\n";
-    cout << "Le plus rapide: " << (tPos < tPow? "PoS" : "PoW") << endl;
+void runBatchMerkle(const BatchOptions& o, BatchRecord& rec) {
+    WorkloadGenerator workload(batchWorkload(o));
+    vector<TxColumns> blocks(o.blocks);
+    for (auto& txs : blocks) workload.fill(txs, o.txsPerBlock);
+    uint64_t check = 0;
+    auto t0 = steady_clock::now();
+    for (auto& txs : blocks) check ^= fastHashWords(computeTxMerkleRoot(txs)).w[0];
+    double ns = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    rec.add("blocks", o.blocks);
+    rec.add("total_ms", ns / 1e6);
+    rec.add("per_block_us", ns / 1e3 / o.blocks);
+    rec.add("txs_per_s", ns ? o.blocks * o.txsPerBlock * 1e9 / ns : 0.0);
+    rec.add("checksum", to_string(check));
+}
 
+void runBatchVerifyScenario(const BatchOptions& o, BatchRecord& rec) {
+    StakeHistory history;
+    SplitMix64 rng(o.seed);
+    vector<pair<string,uint64_t>> stakes;
+    for (int v = 0; v < 64; ++v) stakes.push_back({"val" + to_string(v), 1 + rng.below(1000)});
+    history.set(1, stakes);
+    vector<BlockTx> blocks;
+    blocks.reserve(o.blocks + 1);
+    blocks.emplace_back(0, "0", TxColumns(), string(64, '0'));
+    for (size_t i = 1; i <= o.blocks; ++i) {
+        blocks.emplace_back((int)i, blocks.back().hash, TxColumns(), fastSHA256(to_string(rng.next())));
+        blocks.back().validatePoS(history.at(i)->chooseValidator(blocks[i - 1].hash, i));
+    }
+    auto t0 = steady_clock::now();
+    BatchVerifyResult r = verifyPoSBatch(blocks, 0, blocks.size(), history, o.threads);
+    double ns = (double)duration_cast<nanoseconds>(steady_clock::now() - t0).count();
+    rec.add("blocks", o.blocks);
+    rec.add("total_ms", ns / 1e6);
+    rec.add("blocks_per_s", ns ? blocks.size() * 1e9 / ns : 0.0);
+    rec.add("valid", r.ok());
+}
 
-    cout << "\nVérification blockchain exercice 3: " << (myChain.isValid()?"✔ Valide\n":"✖ Invalide\n");
+// Chaîne produite par le pipeline et écrite dans un magasin temporaire, puis resynchronisée en
+// chaîne légère : en-têtes seuls, vérifiés par le consensus, et quelques corps relus à la demande
+template<class Consensus>
+void runBatchLight(const BatchOptions& o, const Consensus& consensus, BatchRecord& rec) {
+    string path = (filesystem::temp_directory_path() / ("atelier_light_" + to_string(o.seed) + ".dat")).string();
+    filesystem::remove(path);
+    WorkloadGenerator workload(batchWorkload(o));
+    Blockchain bc(workload.genesisAllocations());
+    Mempool mempool;
+    workload.feed(mempool, o.blocks * o.txsPerBlock);
+    {
+        BlockStore store(path);
+        store.append(bc.chain[0]);
+        BlockPipeline(bc, mempool, o.txsPerBlock, 4, o.threads).run(o.blocks, consensus, [&](const BlockTx& b, long long) { store.append(b); });
+    }
+    BlockStore store(path);
+    LightChain light(store);
+    auto t0 = steady_clock::now();
+    size_t synced = light.sync();
+    auto t1 = steady_clock::now();
+    bool headersOk = light.verifyHeaders(consensus) == light.size();
+    auto t2 = steady_clock::now();
+    SplitMix64 rng(o.seed);
+    size_t fetches = min<size_t>(100, light.size() - 1), fetchedOk = 0;
+    BlockTx body;
+    for (size_t k = 0; k < fetches; ++k) fetchedOk += light.fetchBody(1 + rng.below(light.size() - 1), body);
+    auto t3 = steady_clock::now();
+    auto ms = [](auto a, auto b) { return duration_cast<nanoseconds>(b - a).count() / 1e6; };
+    rec.add("blocks", synced);
+    rec.add("header_bytes", sizeof(LightChain::Header));
+    rec.add("light_memory_bytes", light.memoryBytes());
+    rec.add("sync_ms", ms(t0, t1));
+    rec.add("verify_headers_ms", ms(t1, t2));
+    rec.add("fetch_us", fetches ? ms(t2, t3) * 1e3 / fetches : 0.0);
+    rec.add("valid", headersOk && synced == bc.chain.size() && fetchedOk == fetches);
+    filesystem::remove(path);
 }
 
+template<class Consensus>
+void runBatchNetwork(const Consensus& consensus, const NetworkConfig& cfg, BatchRecord& rec) {
+    NetworkReport r = NetworkSimulator<Consensus>(cfg, consensus).run();
+    rec.add("height", r.height);
+    rec.add("produced_blocks", r.producedBlocks);
+    rec.add("seconds", r.seconds);
+    rec.add("orphan_rate", r.orphanRate);
+    rec.add("blocks_per_s", r.blocksPerSec);
+    rec.add("tx_per_s", r.txPerSec);
+    rec.add("confirm_mean_ms", r.confirmMeanMs);
+    rec.add("confirm_p50_ms", r.confirmP50Ms);
+    rec.add("confirm_max_ms", r.confirmMaxMs);
+    rec.add("messages", r.messages);
+    rec.add("dropped", r.dropped);
+    rec.add("agreeing_nodes", r.agreeingNodes);
+    rec.add("reorgs", r.reorgs);
+    rec.add("requeued_txs", r.requeuedTxs);
+    rec.add("valid", r.confirmedMatchesChain);
+}
 
-// Exercice 4 : Blockchain complète + comparaison PoW/PoS
-void runExercice4() {
-    Blockchain myChain;
-    PoSSystem posSystem;
-    vector<vector<Transaction>> listTxs = {
-        {Transaction(1,"Zineb","Merieme",10),Transaction(2,"Hamza","Sara",5)},
-        {Transaction(3,"Yassine","Hajar",2),Transaction(4,"Mouad","Zineb",1)},
-        {Transaction(5,"Ali","Laila",7),Transaction(6,"Sara","Hamza",3)},
-        {Transaction(7,"Ahmed","Omar",8),Transaction(8,"Nora","Yassine",2)}
+int runBatch(int argc, char** argv) {
+    BatchOptions o;
+    try {
+        o = parseBatchOptions(argc, argv);
+    } catch (const invalid_argument& e) {
+        if (*e.what()) cerr << e.what() << "\n";
+        printBatchUsage(*e.what() ? cerr : cout);
+        return *e.what() ? 2 : 0;
+    }
+    if (!o.exportPath.empty() && o.scenario != "chain") { cerr << "--export ne s'applique qu'au scénario chain\n"; return 2; }
+
+    BatchRecord rec;
+    rec.add("scenario", o.scenario);
+    rec.add("consensus", o.scenario == "merkle" ? "-" : o.scenario == "verify" ? "pos" : o.consensus);
+    rec.add("txs_per_block", o.txsPerBlock);
+    rec.add("difficulty", o.difficulty);
+
+    // Le réseau simulé tire sa graine de --seed ; il fait tourner un thread par nœud et ignore --threads
+    NetworkConfig cfg;
+    cfg.targetHeight = (int)o.blocks;
+    cfg.txsPerBlock = o.txsPerBlock;
+    cfg.difficulty = o.difficulty;
+    cfg.seed = o.seed;
+    if (o.scenario == "network") rec.add("threads", cfg.nodes);
+    else rec.add("threads", o.threads ? o.threads : max(1u, thread::hardware_concurrency()));
+    rec.add("seed", o.seed);
+    rec.add("accounts", o.accounts);
+    rec.add("zipf", o.zipf);
+    PoSSystem netValidators(networkValidators(cfg));
+    PoSSystem validators;
+    // Instanciation par consensus : les boucles chaudes restent sans appel virtuel
+    auto dispatch = [&](auto consensus) {
+        if (o.scenario == "chain") runBatchChain(o, consensus, rec);
+        else if (o.scenario == "light") runBatchLight(o, consensus, rec);
+        else runBatchNetwork(consensus, cfg, rec);
     };
-
-    int difficulty=3;
-    long long totalPoWTime=0,totalPoSTime=0;
-
-    cout<<"\n===== Ajout blocs PoW =====\n";
-    for(size_t i=0;i<listTxs.size();++i){
-        BlockTx b(myChain.chain.back().id+1,myChain.chain.back().hash,listTxs[i]);
-        long long t=simulatePoW(b,difficulty); totalPoWTime+=t;
-        myChain.addBlock(b); cout<<"Bloc PoW ajouté:\n"; myChain.printBlock(b); cout<<"Temps minage PoW: "<<t<<" ms\n";
+    if (!o.tracePath.empty()) Tracer::instance().start();
+    if (o.scenario == "merkle") runBatchMerkle(o, rec);
+    else if (o.scenario == "verify") runBatchVerifyScenario(o, rec);
+    else {
+        const PoSSystem& pos = o.scenario == "network" ? netValidators : validators;
+        if (o.consensus == "pow") dispatch(PoWConsensus(o.difficulty));
+        else if (o.consensus == "pos") dispatch(PoSConsensus(pos));
+        else dispatch(HybridConsensus(pos, o.difficulty));
     }
-
-    cout<<"\n===== Ajout blocs PoS =====\n";
-    for(size_t i=0;i<listTxs.size();++i){
-        BlockTx b(myChain.chain.back().id+1,myChain.chain.back().hash,listTxs[i]);
-        long long t=posSystem.simulatePoS(b); totalPoSTime+=t;
-        myChain.addBlock(b); cout<<"Bloc PoS ajouté:\n"; myChain.printBlock(b); cout<<"Temps validation PoS: "<<t<<" ms\n";
+    if (!o.tracePath.empty()) {
+        Tracer::instance().stop();
+        try {
+            rec.add("trace_events", Tracer::instance().writeFile(o.tracePath));
+            rec.add("trace_dropped", Tracer::instance().dropped());
+        } catch (const runtime_error& e) { cerr << e.what() << "\n"; return 1; }
     }
-
-    cout<<"\n===== Vérification Blockchain =====\n";
-    cout<<(myChain.isValid()?"✔ Blockchain valide\n":"✖ Blockchain invalide\n");
-
-    cout<<"\n===== Analyse Comparative =====\n";
-    cout<<left<<setw(20)<<"Critère"<<setw(15)<<"PoW"<<setw(15)<<"PoS"<<endl;
-    cout<<string(50,'-')<<endl;
-    double avgPoW=(double)totalPoWTime/listTxs.size(), avgPoS=(double)totalPoSTime/listTxs.size();
-    cout<<setw(20)<<"Temps moyen/bloc (ms)"<<setw(15)<<avgPoW<<setw(15)<<avgPoS<<endl;
-    uint64_t totalPoWNonces=0; for(size_t i=1;i<=listTxs.size();++i) totalPoWNonces+=myChain.chain[i].nonce;
-    cout<<setw(20)<<"Approx. ressources"<<setw(15)<<totalPoWNonces<<setw(15)<<"faible"<<endl;
-    cout<<setw(20)<<"Facilité implémentation"<<setw(15)<<"Complexe"<<setw(15)<<"Simple"<<endl;
-    cout<<"\nBloc le plus rapide: "<<(totalPoSTime<totalPoWTime?"PoS":"PoW")<<endl;
+    rec.write(cout, o.format);
+    return 0;
 }
 
 
-// Menu principal
-int main() {
-    srand(static_cast<unsigned>(time(nullptr)));
+// Menu principal (sans argument) ou mode non interactif (voir runBatch)
+int main(int argc, char** argv) {
+    Tracer::nameThread("principal");
+    if (argc > 1) return runBatch(argc, argv);
     int choice;
     do {
         cout<<"\n===== MENU PRINCIPAL =====\n";
@@ -370,6 +1163,20 @@ int main() {
         cout<<"2. Exercice 2 : Proof-of-Work simple\n";
         cout<<"3. Exercice 3 : PoW + PoS simplifié\n";
         cout<<"4. Exercice 4 : Blockchain avec transactions et comparaison PoW/PoS\n";
+        cout<<"5. Snapshots d'état et démarrage rapide\n";
+        cout<<"6. Benchmark sélection de validateurs (1M, alias et Fenwick)\n";
+        cout<<"7. Simulation réseau multi-nœuds PoW / PoS / hybride\n";
+        cout<<"8. Minage asynchrone avec annulation\n";
+        cout<<"9. Vérification par lots d'une chaîne PoS\n";
+        cout<<"10. Profil matériel des phases (compteurs perf)\n";
+        cout<<"11. Charge synthétique reproductible (Zipf)\n";
+        cout<<"12. Export de la chaîne (JSONL / binaire)\n";
+        cout<<"13. Mode silencieux pendant les mesures : "<<(quietMode()?"activé":"désactivé")<<"\n";
+        cout<<"14. Trace chronologique de la production de blocs (Perfetto)\n";
+        cout<<"15. Chaîne légère : en-têtes seuls, corps à la demande\n";
+        cout<<"16. Index des adresses : historique et soldes en microsecondes\n";
+        cout<<"17. Index des transactions vues : rejeux refusés\n";
+        cout<<"18. Lecture concurrente de la chaîne pendant les ajouts\n";
         cout<<"0. Quitter\n";
         cout<<"Votre choix: "; cin>>choice;
 
@@ -378,6 +1185,20 @@ int main() {
             case 2: runExercice2(); break;
             case 3: runExercice3(); break;
             case 4: runExercice4(); break;
+            case 5: runSnapshots(); break;
+            case 6: runValidatorBench(); break;
+            case 7: runNetworkSim(); break;
+            case 8: runAsyncMining(); break;
+            case 9: runBatchVerify(); break;
+            case 10: runPhaseProfile(); break;
+            case 11: runWorkload(); break;
+            case 12: runExport(); break;
+            case 13: quietMode()=!quietMode(); cout<<"Mode silencieux "<<(quietMode()?"activé":"désactivé")<<"\n"; break;
+            case 14: runTrace(); break;
+            case 15: runLightChain(); break;
+            case 16: runAddressIndex(); break;
+            case 17: runSeenIndex(); break;
+            case 18: runConcurrentReads(); break;
             case 0: cout<<"Au revoir!\n"; break;
             default: cout<<"Option invalide!\n";
         }
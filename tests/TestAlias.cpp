@@ -0,0 +1,47 @@
+// Table d'alias entière : chaque indice reçoit exactement une masse n * poids sur les n colonnes
+// de T = poids total (aucun arrondi flottant), y compris pour des poids proches de 2^64
+#include "Verif.h"
+
+// Masse de chaque indice : seuil de sa propre colonne + complément des colonnes qui l'ont pour alias
+static bool exactMasses(const vector<uint64_t>& weights) {
+    AliasSampler alias;
+    alias.build(weights);
+    size_t n = weights.size();
+    uint64_t T = alias.total();
+    vector<unsigned __int128> mass(n, 0);
+    for (size_t c = 0; c < n; ++c) {
+        if (alias.threshold(c) > T) return false;
+        mass[c] += alias.threshold(c);
+        mass[alias.aliasOf(c)] += T - alias.threshold(c);
+    }
+    for (size_t i = 0; i < n; ++i) if (mass[i] != (unsigned __int128)weights[i] * n) return false;
+    return true;
+}
+
+int main() {
+    VERIFIE(exactMasses({50, 30, 20}));
+    VERIFIE(exactMasses({1, 1, 1}));
+    VERIFIE(exactMasses({7}));
+    VERIFIE(exactMasses({0, 5, 0, 3}));
+    VERIFIE(exactMasses({1, 999999937, 2, 3, 1000003, 65537}));
+    // Somme proche de 2^64 - 1 : les calculs intermédiaires ne débordent pas
+    VERIFIE(exactMasses({UINT64_MAX / 3, UINT64_MAX / 3, UINT64_MAX / 3 - 12345, 17}));
+    vector<uint64_t> many;
+    SplitMix64 r(31);
+    for (int i = 0; i < 1000; ++i) many.push_back(r.below(1ULL << 50));
+    VERIFIE(exactMasses(many));
+
+    // Poids nul : jamais tiré
+    AliasSampler zero;
+    zero.build({0, 5, 0, 3});
+    SplitMix64 rz(4);
+    for (int i = 0; i < 20000; ++i) { size_t k = zero.sample(rz); VERIFIE(k == 1 || k == 3); }
+
+    // Poids total nul ou supérieur à 2^64 - 1 : refusés
+    AliasSampler bad;
+    bool threwZero = false, threwOverflow = false;
+    try { bad.build({0, 0}); } catch (const invalid_argument&) { threwZero = true; }
+    try { bad.build({UINT64_MAX, 1}); } catch (const overflow_error&) { threwOverflow = true; }
+    VERIFIE(threwZero && threwOverflow);
+    return verifBilan("table d'alias");
+}
@@ -0,0 +1,18 @@
+// Comptage des allocations : actif seulement avec -DATELIER_ALLOC_STATS, sinon les compteurs
+// restent à zéro et allocStatsAvailable() le signale
+#include "Verif.h"
+
+int main() {
+    AllocSample before = threadAllocations();
+    auto p = make_unique<vector<uint64_t>>(1000);
+    AllocSample delta = threadAllocations() - before;
+    if (allocStatsAvailable()) VERIFIE(delta.count >= 2 && delta.bytes >= 1000 * sizeof(uint64_t));
+    else VERIFIE(delta.count == 0 && delta.bytes == 0 && threadAllocations().count == 0);
+
+    // Les compteurs sont propres à chaque thread
+    AllocSample other;
+    thread t([&]{ AllocSample b = threadAllocations(); auto q = make_unique<int>(1); other = threadAllocations() - b; });
+    t.join();
+    VERIFIE(other.count == (allocStatsAvailable() ? 1u : 0u));
+    return verifBilan("comptage des allocations");
+}
@@ -0,0 +1,51 @@
+// Chaîne légère : en-têtes seuls, corps relus à la demande et vérifiés contre la racine Merkle
+// de l'en-tête ; un corps substitué ou d'une autre hauteur est refusé
+#include "Verif.h"
+
+int main() {
+    string dir = verifRepertoire("legere");
+    WorkloadConfig cfg;
+    cfg.accounts = 100;
+    WorkloadGenerator gen(cfg);
+    Blockchain bc(gen.genesisAllocations());
+    PoSSystem pos;
+    ConsensusChain<PoSConsensus> chain(bc, PoSConsensus(pos));
+    for (int i = 0; i < 6; ++i) { TxColumns t; gen.fill(t, 30); VERIFIE(chain.produce(std::move(t))); }
+
+    // Magasin complet puis synchronisation des en-têtes
+    BlockStore store(dir + "/blocks.dat");
+    vector<uint64_t> offsets;
+    for (const BlockTx& b : bc.chain.snapshot()) offsets.push_back(store.append(b));
+    LightChain light(store);
+    VERIFIE(light.sync() == bc.chain.size() && light.height() == 6);
+    VERIFIE(light.verifyHeaders(PoSConsensus(pos)) == light.size());
+    for (size_t i = 0; i < light.size(); ++i) {
+        BlockTx body;
+        VERIFIE(light.fetchBody(i, body));
+        VERIFIE(body.hash == bc.chain[i].hash && body.transactions.ids == bc.chain[i].transactions.ids
+                && body.transactions.amounts == bc.chain[i].transactions.amounts);
+    }
+
+    // En-tête sans corps fidèle : transactions substituées sous le même en-tête
+    BlockStore forgedStore(dir + "/forged.dat");
+    LightChain forged(forgedStore);
+    for (size_t i = 0; i < 3; ++i) VERIFIE(forged.append(bc.chain[i], forgedStore.append(bc.chain[i])));
+    BlockTx swapped = bc.chain[3];
+    swapped.transactions.amounts[0] += 1;
+    VERIFIE(forged.append(bc.chain[3], forgedStore.append(swapped)));
+    // Corps d'une autre hauteur à l'offset annoncé
+    VERIFIE(forged.append(bc.chain[4], forgedStore.append(bc.chain[1])));
+    BlockTx body;
+    VERIFIE(forged.fetchBody(2, body) && body.hash == bc.chain[2].hash);
+    VERIFIE(!forged.fetchBody(3, body));
+    VERIFIE(!forged.fetchBody(4, body));
+    VERIFIE(!forged.fetchBody(5, body));
+
+    // Les en-têtes eux-mêmes : hash incohérent ou chaînage rompu refusés
+    BlockTx badHash = bc.chain[5];
+    badHash.nonce += 1;
+    VERIFIE(!forged.append(badHash, 0));
+    VERIFIE(!forged.append(bc.chain[6], 0));
+    VERIFIE(forged.height() == 4);
+    return verifBilan("chaîne légère");
+}
@@ -0,0 +1,26 @@
+// Comptes internés et transactions en colonnes
+#include "Verif.h"
+
+int main() {
+    AccountTable table;
+    AccountId a = table.intern("Zineb"), b = table.intern("Hamza");
+    VERIFIE(a != b);
+    VERIFIE(table.intern("Zineb") == a);
+    VERIFIE(table.name(b) == "Hamza");
+    VERIFIE(table.size() == 2);
+    AccountId found = 99;
+    VERIFIE(table.find("Hamza", found) && found == b);
+    VERIFIE(!table.find("Inconnu", found));
+    VERIFIE(table.size() == 2); // find n'interne pas
+
+    vector<Transaction> txs = {Transaction(1, "Zineb", "Merieme", 10), Transaction(2, "Hamza", "Sara", 5.5)};
+    TxColumns cols(txs);
+    VERIFIE(cols.size() == 2);
+    for (size_t k = 0; k < txs.size(); ++k) {
+        Transaction t = cols.get(k);
+        VERIFIE(t.id == txs[k].id && t.sender == txs[k].sender && t.receiver == txs[k].receiver && t.amount == txs[k].amount);
+    }
+    VERIFIE(cols.amounts[1] == toAmount(5.5));
+    VERIFIE(accounts().name(cols.senders[0]) == "Zineb");
+    return verifBilan("comptes et colonnes");
+}
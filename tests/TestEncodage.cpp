@@ -0,0 +1,44 @@
+// Encodage binaire canonique : aller-retour des transactions et des blocs, tampons tronqués
+#include "Verif.h"
+
+int main() {
+    Transaction tx(42, "Zineb", "Merieme", 12.34567891);
+    string enc = encodeTx(tx);
+    VERIFIE(enc.size() == encodedTxSize(tx));
+    size_t pos = 0;
+    Transaction back(0, 0, 0, 0);
+    VERIFIE(decodeTx(enc, pos, back) && pos == enc.size());
+    VERIFIE(back.id == tx.id && back.sender == tx.sender && back.receiver == tx.receiver && back.amount == tx.amount);
+    VERIFIE(encodeTx(back) == enc);
+    for (size_t cut = 0; cut < enc.size(); ++cut) {
+        size_t p = 0;
+        VERIFIE(!decodeTx(enc.substr(0, cut), p, back));
+    }
+
+    // Bloc scellé : l'aller-retour conserve en-tête, transactions, hash et racine Merkle
+    vector<Transaction> txs = {tx, Transaction(43, "Hamza", "Sara", 5), Transaction(44, "Sara", "Zineb", 0.00000001)};
+    BlockTx b(7, string(64, 'a'), TxColumns(txs));
+    b.mineBlock(1);
+    string blk;
+    encodeBlock(b, blk);
+    BlockTx d;
+    pos = 0;
+    VERIFIE(decodeBlock(blk, pos, d) && pos == blk.size());
+    VERIFIE(d.id == b.id && d.timestamp == b.timestamp && d.nonce == b.nonce && d.prevHash == b.prevHash);
+    VERIFIE(d.merkleRoot == b.merkleRoot && d.validator == b.validator && d.hash == b.hash);
+    VERIFIE(d.transactions.size() == txs.size());
+    VERIFIE(d.transactions.ids == b.transactions.ids && d.transactions.amounts == b.transactions.amounts);
+    VERIFIE(d.transactions.senders == b.transactions.senders && d.transactions.receivers == b.transactions.receivers);
+    VERIFIE(d.hashMatches() && computeTxMerkleRoot(d.transactions) == d.merkleRoot);
+    string again;
+    encodeBlock(d, again);
+    VERIFIE(again == blk);
+
+    // En-tête seul : mêmes champs, transactions laissées de côté
+    BlockTx h;
+    pos = 0;
+    VERIFIE(decodeBlockHeader(blk, pos, h) && h.hash == b.hash && h.merkleRoot == b.merkleRoot);
+    pos = 0;
+    VERIFIE(!decodeBlock(blk.substr(0, blk.size() - 1), pos, d));
+    return verifBilan("encodage canonique");
+}
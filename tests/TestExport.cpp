@@ -0,0 +1,111 @@
+// Export de la chaîne : l'export binaire se relit par BlockStore, l'export JSONL se relit champ
+// par champ ; dans les deux cas les blocs reconstruits ont le même hash et la même racine Merkle
+#include "Verif.h"
+
+// Lecteur minimal du JSONL de ChainExporter : ordre des champs connu, chaînes échappées
+struct JsonLine {
+    const string& s;
+    size_t p = 0;
+    void expect(const char* lit) { size_t n = strlen(lit); if (s.compare(p, n, lit) != 0) throw runtime_error(string("attendu ") + lit); p += n; }
+    string str() {
+        expect("\"");
+        string out;
+        while (s[p] != '"') {
+            if (s[p] != '\\') { out += s[p++]; continue; }
+            char c = s[p + 1];
+            if (c == 'u') { out += (char)stoi(s.substr(p + 2, 4), nullptr, 16); p += 6; }
+            else { out += c; p += 2; }
+        }
+        ++p;
+        return out;
+    }
+    string token() { size_t b = p; while (p < s.size() && s[p] != ',' && s[p] != '}' && s[p] != ']') ++p; return s.substr(b, p - b); }
+};
+
+// "12.5" -> 1250000000 (8 décimales au plus, comme formatAmount)
+static Amount parseAmount(const string& v) {
+    bool neg = v[0] == '-';
+    size_t dot = v.find('.');
+    string whole = v.substr(neg, dot == string::npos ? string::npos : dot - neg);
+    string frac = dot == string::npos ? "" : v.substr(dot + 1);
+    frac.resize(8, '0');
+    Amount a = (Amount)stoll(whole) * AMOUNT_SCALE + (Amount)stoll(frac);
+    return neg ? -a : a;
+}
+
+static BlockTx fromJson(const string& line) {
+    JsonLine j{line};
+    BlockTx b;
+    j.expect("{\"id\":"); b.id = stoi(j.token());
+    j.expect(",\"timestamp\":"); b.timestamp = (time_t)stoll(j.token());
+    j.expect(",\"prevHash\":"); b.prevHash = j.str();
+    j.expect(",\"merkleRoot\":"); b.merkleRoot = j.str();
+    j.expect(",\"nonce\":"); b.nonce = stoull(j.token());
+    j.expect(",\"validator\":"); b.validator = j.str();
+    j.expect(",\"hash\":"); b.hash = j.str();
+    j.expect(",\"txs\":[");
+    for (bool first = true; line[j.p] != ']'; first = false) {
+        if (!first) j.expect(",");
+        j.expect("{\"id\":"); int id = stoi(j.token());
+        j.expect(",\"from\":"); string from = j.str();
+        j.expect(",\"to\":"); string to = j.str();
+        j.expect(",\"amount\":"); Amount a = parseAmount(j.token());
+        j.expect("}");
+        b.transactions.push(Transaction(id, accounts().intern(from), accounts().intern(to), a));
+    }
+    j.expect("]}");
+    return b;
+}
+
+static bool sameBlock(const BlockTx& a, const BlockTx& b) {
+    return a.hash == b.hash && b.hashMatches() && a.prevHash == b.prevHash && a.validator == b.validator
+        && computeTxMerkleRoot(b.transactions) == a.merkleRoot && a.transactions.ids == b.transactions.ids
+        && a.transactions.senders == b.transactions.senders && a.transactions.receivers == b.transactions.receivers
+        && a.transactions.amounts == b.transactions.amounts;
+}
+
+int main() {
+    string dir = verifRepertoire("export");
+    // Noms à échapper en JSON, montants fractionnaires et négatif
+    Blockchain bc({{"exp \"guillemets\"", 100}, {"exp\\barre", 100}, {"exp\tonglet", 100}});
+    PoSSystem pos;
+    ConsensusChain<PoSConsensus> chain(bc, PoSConsensus(pos));
+    vector<Transaction> txs = {Transaction(1, "exp \"guillemets\"", "exp\\barre", 12.5),
+                               Transaction(2, "exp\\barre", "exp\tonglet", 0.00000001),
+                               Transaction(3, "exp\tonglet", "exp-é", 3)};
+    VERIFIE(chain.produce(TxColumns(txs)));
+    VERIFIE(chain.produce(TxColumns(vector<Transaction>{Transaction(4, "exp-é", "exp \"guillemets\"", 1.25)})));
+    VERIFIE(chain.produce(TxColumns()));
+
+    string jsonPath = dir + "/chaine.jsonl", binPath = dir + "/chaine.bin";
+    size_t exported;
+    {
+        OutputSink json(jsonPath), bin(binPath);
+        ChainExporter(json, ChainExporter::JSONL).write(bc);
+        ChainExporter ex(bin, ChainExporter::BINARY);
+        ex.write(bc);
+        exported = ex.blocks();
+        json.flush(); bin.flush();
+        VERIFIE(json.ok() && bin.ok());
+    }
+    VERIFIE(exported == bc.chain.size());
+
+    // Binaire : enregistrements du magasin de blocs
+    BlockStore store(binPath);
+    uint64_t offset = 0, next;
+    size_t i = 0;
+    BlockTx b;
+    for (; store.readAt(offset, b, &next); offset = next, ++i) VERIFIE(i < bc.chain.size() && sameBlock(bc.chain[i], b));
+    VERIFIE(i == bc.chain.size());
+
+    // JSONL : une ligne par bloc
+    ifstream in(jsonPath);
+    string line;
+    i = 0;
+    for (; getline(in, line); ++i) {
+        try { VERIFIE(i < bc.chain.size() && sameBlock(bc.chain[i], fromJson(line))); }
+        catch (const exception& e) { VERIFIE(!"ligne JSONL illisible"); cerr << e.what() << "\n"; }
+    }
+    VERIFIE(i == bc.chain.size());
+    return verifBilan("export JSONL et binaire");
+}
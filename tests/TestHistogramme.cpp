@@ -0,0 +1,47 @@
+// Histogramme HDR : chaque percentile est encadré par la valeur exacte et celle-ci + 1/32,
+// sur toute la plage 64 bits ; fusion identique à l'enregistrement direct
+#include "Verif.h"
+
+// percentile(q) >= valeur exacte de rang ceil(q*n), et au plus 1/32 au-dessus
+static bool bounded(const Histogram& h, vector<uint64_t> v, double q) {
+    sort(v.begin(), v.end());
+    size_t rank = max<size_t>(1, (size_t)ceil(q * v.size()));
+    uint64_t exact = v[rank - 1], got = h.percentile(q);
+    return got >= exact && (long double)got <= (long double)exact * (1 + 1.0L / Histogram::SUB) && got <= h.max();
+}
+
+int main() {
+    Histogram empty;
+    VERIFIE(empty.count() == 0 && empty.percentile(0.5) == 0 && empty.min() == 0 && empty.mean() == 0);
+
+    // Petites valeurs (< 32) : un compteur par valeur, percentiles exacts
+    Histogram small;
+    for (uint64_t v = 0; v < 32; ++v) small.record(v);
+    VERIFIE(small.percentile(0.5) == 15 && small.percentile(1) == 31 && small.percentile(0) == 0);
+
+    // Latences à queue lourde, hashes, valeurs proches de 2^64
+    SplitMix64 r(39);
+    vector<uint64_t> values[3];
+    Histogram hist[3], merged;
+    for (int i = 0; i < 20000; ++i) {
+        values[0].push_back(1000 + (uint64_t)(1e6 * pow(r.uniform(), 4)));
+        values[1].push_back(r.below(1ULL << 40));
+        values[2].push_back(UINT64_MAX - r.below(1ULL << 62));
+    }
+    for (int k = 0; k < 3; ++k) {
+        for (uint64_t v : values[k]) hist[k].record(v);
+        merged.merge(hist[k]);
+        for (double q : {0.0, 0.01, 0.5, 0.9, 0.99, 0.999, 1.0}) VERIFIE(bounded(hist[k], values[k], q));
+        VERIFIE(hist[k].percentile(1) == *max_element(values[k].begin(), values[k].end()));
+        VERIFIE(hist[k].min() == *min_element(values[k].begin(), values[k].end()));
+    }
+    VERIFIE(fabs(hist[0].mean() - accumulate(values[0].begin(), values[0].end(), 0.0) / values[0].size()) < 1e-6 * hist[0].mean());
+
+    // Fusion : mêmes réponses qu'un seul histogramme alimenté par toutes les valeurs
+    vector<uint64_t> all;
+    Histogram direct;
+    for (auto& v : values) { all.insert(all.end(), v.begin(), v.end()); for (uint64_t x : v) direct.record(x); }
+    VERIFIE(merged.count() == all.size() && merged.max() == direct.max() && merged.min() == direct.min());
+    for (double q : {0.1, 0.5, 0.75, 0.99}) VERIFIE(merged.percentile(q) == direct.percentile(q) && bounded(merged, all, q));
+    return verifBilan("histogramme des latences");
+}
@@ -0,0 +1,44 @@
+// Consensus hybride : validateur désigné par PoS, puis cible PoW légère atteinte par étapes
+// (sealStep reprend là où il s'est arrêté), vérifiée par les trois règles
+#include "Verif.h"
+
+int main() {
+    PoSSystem pos;
+    const int difficulty = 2;
+    HybridConsensus hybrid(pos, difficulty);
+    Blockchain bc;
+    BlockTx b(1, bc.chain.back().hash, TxColumns());
+    BlockTx whole = b;
+
+    // Une étape d'un hash : le validateur est fixé dès la première, le nonce avance d'un cran
+    VERIFIE(b.validator.empty());
+    bool sealed = hybrid.sealStep(b, 1);
+    VERIFIE(b.validator == pos.chooseValidator(b.prevHash, b.id) && b.nonce == 1);
+    uint64_t steps = 1;
+    while (!sealed) { sealed = hybrid.sealStep(b, 1); ++steps; VERIFIE(b.nonce == steps); }
+    VERIFIE(b.hashMatches() && meetsDifficulty(b.hash, difficulty));
+    VERIFIE(hybrid.verify(b) && PoWConsensus(difficulty).verify(b) && PoSConsensus(pos).verify(b));
+
+    // Par étapes de 7 hashes ou d'un coup : même nonce, même hash
+    BlockTx chunked = whole;
+    while (!hybrid.sealStep(chunked, 7)) {}
+    hybrid.seal(whole);
+    VERIFIE(whole.nonce == b.nonce && whole.hash == b.hash);
+    VERIFIE(chunked.nonce >= b.nonce && chunked.nonce < b.nonce + 7 && meetsDifficulty(chunked.hash, difficulty));
+
+    // Cible atteinte mais mauvais validateur, ou bon validateur sans la cible : refusé
+    BlockTx impostor = whole;
+    impostor.validator = impostor.validator == "Alice" ? "Bob" : "Alice";
+    while (!PoWConsensus(difficulty).sealStep(impostor, UINT64_MAX)) {}
+    VERIFIE(!hybrid.verify(impostor));
+    BlockTx lazy(1, bc.chain.back().hash, TxColumns());
+    lazy.validatePoS(pos.chooseValidator(lazy.prevHash, lazy.id));
+    while (meetsDifficulty(lazy.hash, difficulty)) { ++lazy.nonce; lazy.calculateHash(); }
+    VERIFIE(!hybrid.verify(lazy));
+
+    // Chaîne produite en hybride : valide selon la politique
+    ConsensusChain<HybridConsensus> chain(bc, hybrid);
+    for (int i = 0; i < 5; ++i) VERIFIE(chain.produce(TxColumns()));
+    VERIFIE(bc.chain.size() == 6 && chain.isValid());
+    return verifBilan("consensus hybride");
+}
@@ -0,0 +1,89 @@
+// Index des adresses : postings et soldes contre un parcours de la chaîne, solde à une hauteur,
+// pagination de l'historique, filtres de Bloom sans faux négatif, émetteur du genesis non débité
+#include "Verif.h"
+
+int main() {
+    const size_t nBlocks = 60, perBlock = 50;
+    WorkloadConfig cfg;
+    cfg.accounts = 300;
+    WorkloadGenerator gen(cfg);
+    PoSSystem pos;
+    Blockchain bc(gen.genesisAllocations());
+    AddressIndex index(bc);
+    for (size_t i = 0; i < nBlocks; ++i) {
+        TxColumns txs;
+        gen.fill(txs, perBlock);
+        BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(txs));
+        b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+        VERIFIE(bc.addBlock(b) && index.append(bc.chain.back()));
+    }
+    VERIFIE(index.blocks() == nBlocks + 1 && index.transactions() == nBlocks * perBlock + cfg.accounts + 1);
+    VERIFIE(!index.append(bc.chain[5]));
+
+    // Référence : postings et soldes nets recalculés par un parcours de la chaîne
+    AccountId issuer = Blockchain::issuer();
+    vector<vector<AddressIndex::Posting>> ref(accounts().size());
+    vector<Amount> net(accounts().size(), 0);
+    for (const BlockTx& b : bc.chain) {
+        const TxColumns& t = b.transactions;
+        for (size_t k = 0; k < t.size(); ++k) {
+            AccountId s = t.senders[k], r = t.receivers[k];
+            if (s != issuer) net[s] -= t.amounts[k];
+            net[r] += t.amounts[k];
+            ref[s].push_back({(uint32_t)b.id, (uint32_t)k, net[s]});
+            if (r != s) ref[r].push_back({(uint32_t)b.id, (uint32_t)k, net[r]});
+        }
+    }
+    vector<AccountId> probe = {issuer};
+    for (size_t a = 0; a < cfg.accounts; ++a) probe.push_back(gen.account(a));
+    vector<Amount> reference = computeBalances(bc);
+    size_t postingErrors = 0, balanceErrors = 0, atErrors = 0;
+    for (AccountId a : probe) {
+        const auto& p = index.postings(a);
+        postingErrors += p.size() != ref[a].size();
+        for (size_t j = 0; j < min(p.size(), ref[a].size()); ++j)
+            postingErrors += p[j].height != ref[a][j].height || p[j].tx != ref[a][j].tx || p[j].balanceAfter != ref[a][j].balanceAfter;
+        // Solde courant : celui du registre, genesis compris (jamais débité, donc nul)
+        balanceErrors += index.balance(a) != bc.ledger.balances[a] || index.balance(a) != reference[a];
+        // Solde à chaque hauteur : dernier posting de hauteur <= h
+        for (uint32_t h = 0; h <= nBlocks; ++h) {
+            Amount expected = 0;
+            for (const auto& x : ref[a]) if (x.height <= h) expected = x.balanceAfter;
+            atErrors += index.balanceAt(a, h) != expected;
+        }
+    }
+    VERIFIE(postingErrors == 0);
+    VERIFIE(balanceErrors == 0 && index.balance(issuer) == 0);
+    VERIFIE(atErrors == 0);
+
+    // Pagination : une page commence au premier posting de hauteur >= from et en garde au plus limit
+    size_t pageErrors = 0;
+    for (AccountId a : {gen.account(0), gen.account(1), gen.account(cfg.accounts - 1)}) {
+        const auto& p = index.postings(a);
+        for (uint32_t from : {0u, 1u, 17u, 30u, (uint32_t)nBlocks, (uint32_t)nBlocks + 5})
+            for (size_t limit : {(size_t)0, (size_t)1, (size_t)7, p.size() + 3}) {
+                auto page = index.history(a, from, limit);
+                size_t start = 0;
+                while (start < p.size() && p[start].height < from) ++start;
+                pageErrors += page.first != p.data() + start || (size_t)(page.second - page.first) != min(limit, p.size() - start);
+            }
+    }
+    VERIFIE(pageErrors == 0);
+
+    // Filtres de Bloom : tout compte d'un bloc y est annoncé ; hors plage, aucun bloc
+    size_t falseNegatives = 0, falsePositives = 0, absent = 0;
+    for (const BlockTx& b : bc.chain) {
+        vector<char> in(accounts().size(), 0);
+        const TxColumns& t = b.transactions;
+        for (size_t k = 0; k < t.size(); ++k) in[t.senders[k]] = in[t.receivers[k]] = 1;
+        for (AccountId a : probe) {
+            bool may = index.mayContain((uint32_t)b.id, a);
+            if (in[a]) falseNegatives += !may;
+            else { ++absent; falsePositives += may; }
+        }
+    }
+    VERIFIE(falseNegatives == 0);
+    VERIFIE(falsePositives * 20 < absent);
+    VERIFIE(!index.mayContain((uint32_t)nBlocks + 1, gen.account(0)));
+    return verifBilan("index des adresses");
+}
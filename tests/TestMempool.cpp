@@ -0,0 +1,62 @@
+// Mempool : ordre par frais puis par arrivée, refus des doublons (en attente ou déjà dans la
+// chaîne), soumissions concurrentes pendant l'assemblage de gabarits
+#include "Verif.h"
+
+int main() {
+    AccountId a = accounts().intern("mp-a"), b = accounts().intern("mp-b");
+    auto tx = [&](int id) { return Transaction(id, a, b, toAmount(1)); };
+
+    // Frais décroissants ; à frais égaux, ordre d'arrivée même entre shards différents
+    Mempool pool;
+    int fees[] = {3, 1, 3, 2, 1, 3, 2};
+    for (int i = 0; i < 7; ++i) VERIFIE(pool.submit(tx(100 + i), fees[i]));
+    VERIFIE(!pool.submit(tx(103), 9));
+    Amount total = 0;
+    TxColumns first = pool.buildTemplate(4, SIZE_MAX, &total);
+    VERIFIE((first.ids == vector<int>{100, 102, 105, 103}) && total == 11);
+    // Les transactions non retenues gardent leur rang
+    TxColumns rest = pool.buildTemplate(10);
+    VERIFIE((rest.ids == vector<int>{106, 101, 104}) && pool.size() == 0);
+    // Sortie du mempool : le même id peut être soumis à nouveau
+    VERIFIE(pool.submit(tx(100), 1));
+
+    // Limite en octets : arrêt à la première transaction qui ne tient pas, rien n'est perdu
+    Mempool small;
+    for (int i = 0; i < 10; ++i) small.submit(tx(i), 10 - i);
+    TxColumns part = small.buildTemplate(10, 3 * encodedTxSize(tx(0)));
+    VERIFIE(part.size() == 3 && part.ids[0] == 0 && small.size() == 7);
+
+    // Mempool adossé à la chaîne : une transaction déjà incluse est refusée dès la soumission
+    Blockchain bc({{"mp-a", 100}});
+    Mempool chained(bc.seen);
+    BlockTx blk(1, bc.chain.back().hash, TxColumns(vector<Transaction>{tx(7)}));
+    VERIFIE(bc.addBlock(blk));
+    VERIFIE(!chained.submit(tx(7), 5) && chained.submit(tx(8), 5));
+
+    // 4 producteurs (ids en partie communs) pendant qu'un assembleur vide le mempool
+    Mempool shared;
+    const int perThread = 20000;
+    atomic<int> accepted{0};
+    atomic<bool> producing{true};
+    vector<int> drained;
+    thread builder([&] {
+        while (producing || shared.size()) {
+            TxColumns t = shared.buildTemplate(500);
+            drained.insert(drained.end(), t.ids.begin(), t.ids.end());
+        }
+    });
+    vector<thread> producers;
+    for (int p = 0; p < 4; ++p) producers.emplace_back([&, p] {
+        for (int i = 0; i < perThread; ++i) if (shared.submit(tx(p * perThread / 2 + i), i % 7)) ++accepted;
+    });
+    for (auto& t : producers) t.join();
+    producing = false;
+    builder.join();
+    // Tout ce qui a été accepté est sorti une fois ; un id déjà sorti peut être resoumis par un
+    // autre producteur, mais chacun des ids 0 .. 2.5*perThread-1 apparaît
+    VERIFIE((int)drained.size() == accepted);
+    sort(drained.begin(), drained.end());
+    drained.erase(unique(drained.begin(), drained.end()), drained.end());
+    VERIFIE((int)drained.size() == 5 * perThread / 2 && drained.front() == 0 && drained.back() == 5 * perThread / 2 - 1);
+    return verifBilan("mempool");
+}
@@ -0,0 +1,41 @@
+// Minage asynchrone : nonce valide, premiers nonces essayés, destruction sans attendre
+// les minages non annulés
+#include "Verif.h"
+
+int main() {
+    WorkloadConfig cfg;
+    cfg.accounts = 50;
+    WorkloadGenerator gen(cfg);
+    TxColumns txs;
+    gen.fill(txs, 30);
+    BlockTx b(1, string(64, '0'), txs);
+
+    {
+        AsyncMiner miner(3);
+        // Le nonce trouvé est valide et le bloc garde ses transactions
+        MiningResult r = miner.mine(b, 2).result.get();
+        VERIFIE(r.found && r.block.hashMatches() && r.block.hash.compare(0, 2, "00") == 0);
+        VERIFIE(r.block.transactions.size() == 30 && r.block.merkleRoot == b.merkleRoot);
+
+        // Difficulté nulle : le premier hash suffit, donc l'un des nonces b.nonce..b.nonce+2
+        b.nonce = 100;
+        r = miner.mine(b, 0).result.get();
+        VERIFIE(r.found && r.block.nonce >= 100 && r.block.nonce < 103 && r.block.hashMatches());
+
+        MiningHandle h = miner.mine(b, 64);
+        h.cancel();
+        VERIFIE(!h.result.get().found);
+        MiningStats st = miner.stats();
+        VERIFIE(st.jobs == 3 && st.cancelledJobs == 1);
+    }
+
+    // Minage impossible jamais annulé : le destructeur l'interrompt et livre un résultat vide
+    future<MiningResult> pending;
+    {
+        AsyncMiner miner(2);
+        pending = miner.mine(b, 64).result;
+    }
+    MiningResult r = pending.get();
+    VERIFIE(!r.found && r.block.transactions.size() == 30);
+    return verifBilan("minage asynchrone");
+}
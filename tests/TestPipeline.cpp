@@ -0,0 +1,50 @@
+// Pipeline de production : addBlock exige le chaînage, et un bloc refusé arrête la production
+// au lieu de laisser les suivants se raccrocher à un parent absent
+#include "Verif.h"
+
+// PoS, sauf pour le bloc badId dont le prevHash est altéré après coup : addBlock doit le refuser
+struct BrokenLinkConsensus {
+    PoSConsensus pos;
+    int badId;
+    void seal(BlockTx& b) const {
+        pos.seal(b);
+        if (b.id == badId) { b.prevHash[0] = b.prevHash[0] == 'f' ? 'e' : 'f'; b.calculateHash(); }
+    }
+};
+
+int main() {
+    PoSSystem stakes;
+    WorkloadConfig cfg;
+    cfg.accounts = 100;
+    WorkloadGenerator gen(cfg);
+
+    // addBlock : parent et hauteur doivent prolonger la pointe
+    Blockchain bc(gen.genesisAllocations());
+    TxColumns txs;
+    gen.fill(txs, 5);
+    BlockTx orphan(1, string(64, 'f'), txs);
+    VERIFIE(!bc.addBlock(orphan));
+    BlockTx skip(2, bc.chain.back().hash, txs);
+    VERIFIE(!bc.addBlock(skip));
+    BlockTx ok(1, bc.chain.back().hash, txs);
+    VERIFIE(bc.addBlock(ok) && bc.chain.size() == 2);
+
+    // Bloc 3 refusé : production arrêtée, chaîne valide jusqu'au bloc 2
+    Blockchain chain(gen.genesisAllocations());
+    Mempool mempool;
+    gen.feed(mempool, 10 * 20);
+    BlockPipeline pipeline(chain, mempool, 20, 2);
+    PipelineStats st = pipeline.run(10, BrokenLinkConsensus{PoSConsensus(stakes), 3});
+    VERIFIE(!st.ok() && st.rejectedBlock == 3);
+    VERIFIE(st.blocks == 2 && chain.chain.size() == 3);
+    VERIFIE(chain.isValid());
+
+    // Sans incident : tous les blocs sont ajoutés
+    Blockchain clean(gen.genesisAllocations());
+    Mempool full;
+    gen.feed(full, 10 * 20);
+    BlockPipeline good(clean, full, 20, 2);
+    PipelineStats st2 = good.run(10, PoSConsensus(stakes));
+    VERIFIE(st2.ok() && st2.blocks == 10 && clean.chain.size() == 11 && clean.isValid());
+    return verifBilan("pipeline de production");
+}
@@ -0,0 +1,63 @@
+// Registre des soldes : sémantique séquentielle, bloc atomique (annulation au moindre refus),
+// application parallèle par vagues identique à l'application séquentielle
+#include "Verif.h"
+
+int main() {
+    AccountId a = accounts().intern("reg-a"), b = accounts().intern("reg-b"), c = accounts().intern("reg-c");
+    Ledger ledger;
+    ledger.credit(a, toAmount(10));
+
+    // b reçoit de a avant de payer c : accepté grâce à l'ordre du bloc
+    TxColumns ok(vector<Transaction>{Transaction(1, a, b, toAmount(6)), Transaction(2, b, c, toAmount(5))});
+    VERIFIE(ledger.applyBlock(ok));
+    VERIFIE(ledger.balance(a) == toAmount(4) && ledger.balance(b) == toAmount(1) && ledger.balance(c) == toAmount(5));
+
+    // Découvert en position 1, montant négatif en position 2 : rien n'est appliqué
+    Ledger before = ledger;
+    TxColumns bad(vector<Transaction>{Transaction(3, a, b, toAmount(1)), Transaction(4, b, c, toAmount(50)), Transaction(5, c, a, toAmount(-1))});
+    vector<size_t> rejected;
+    VERIFIE(!ledger.applyBlock(bad, &rejected));
+    VERIFIE((rejected == vector<size_t>{1, 2}));
+    VERIFIE(ledger.balances == before.balances);
+
+    // Solde du destinataire proche du maximum : le crédit déborderait, refusé comme un découvert
+    AccountId rich = accounts().intern("reg-riche");
+    ledger.credit(rich, numeric_limits<Amount>::max() - toAmount(1));
+    TxColumns wrap(vector<Transaction>{Transaction(6, a, rich, toAmount(2))});
+    rejected.clear();
+    VERIFIE(!ledger.applyBlock(wrap, &rejected) && rejected == vector<size_t>{0});
+    VERIFIE(ledger.balance(a) == toAmount(4) && ledger.balance(rich) == numeric_limits<Amount>::max() - toAmount(1));
+
+    // Bloc assez grand pour la voie parallèle : même résultat et mêmes refus qu'en séquentiel
+    WorkloadConfig cfg;
+    cfg.accounts = 2000;
+    cfg.initialBalance = 5;
+    WorkloadGenerator gen(cfg);
+    Ledger seq, par;
+    for (size_t i = 0; i < cfg.accounts; ++i) { seq.credit(gen.account(i), toAmount(5)); par.credit(gen.account(i), toAmount(5)); }
+    TxColumns big;
+    gen.fill(big, Ledger::PARALLEL_MIN_TXS * 2);
+    vector<size_t> rejSeq, rejPar;
+    bool okSeq = seq.applyBlock(big, &rejSeq, 1), okPar = par.applyBlock(big, &rejPar, 4);
+    VERIFIE(okSeq == okPar && rejSeq == rejPar);
+    VERIFIE(seq.balances == par.balances);
+    if (!okSeq) {
+        // Refus : les deux registres sont revenus aux soldes initiaux
+        for (size_t i = 0; i < cfg.accounts; ++i) VERIFIE(par.balance(gen.account(i)) == toAmount(5));
+    }
+    VERIFIE(!okSeq); // soldes de 5 : des découverts sont attendus
+
+    // Soldes suffisants : le bloc passe, en parallèle comme en séquentiel
+    for (size_t i = 0; i < cfg.accounts; ++i) { seq.credit(gen.account(i), toAmount(1e9)); par.credit(gen.account(i), toAmount(1e9)); }
+    VERIFIE(seq.applyBlock(big, nullptr, 1) && par.applyBlock(big, nullptr, 4));
+    VERIFIE(seq.balances == par.balances);
+
+    // Blocs successifs sur le pool persistant, avec plus puis moins de threads
+    for (unsigned threads : {4u, 6u, 2u}) {
+        TxColumns more;
+        gen.fill(more, Ledger::PARALLEL_MIN_TXS);
+        VERIFIE(seq.applyBlock(more, nullptr, 1) && par.applyBlock(more, nullptr, threads));
+        VERIFIE(seq.balances == par.balances);
+    }
+    return verifBilan("registre des soldes");
+}
@@ -0,0 +1,84 @@
+// Index des transactions vues : doublons dans un bloc, rejeux d'une transaction déjà incluse,
+// détection conservée après une restauration depuis un snapshot, et rejeu repéré par isValid
+#include "Verif.h"
+
+int main() {
+    string dir = verifRepertoire("rejeux");
+    WorkloadConfig cfg;
+    cfg.accounts = 200;
+    WorkloadGenerator gen(cfg);
+    PoSSystem pos;
+    auto sealed = [&](const Blockchain& bc, TxColumns txs) {
+        BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(txs));
+        b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+        return b;
+    };
+    // Bloc scellé au-dessus de la pointe puis proposé à la chaîne
+    auto accepts = [&](Blockchain& bc, TxColumns txs) { BlockTx b = sealed(bc, std::move(txs)); return bc.addBlock(b); };
+
+    // Index seul : insertion, présence, répétition dans un même lot, agrandissement par lot
+    SeenTxIndex idx;
+    TxColumns a;
+    gen.fill(a, 3000);
+    VERIFIE(idx.findDuplicates(a) == 0);
+    idx.insertBlock(a);
+    VERIFIE(idx.size() == 3000 && idx.findDuplicates(a) == 3000);
+    TxColumns twice;
+    gen.fill(twice, 4);
+    twice.push(twice.get(1));
+    vector<size_t> where;
+    VERIFIE(idx.findDuplicates(twice, &where) == 1 && where == vector<size_t>{4});
+    vector<uint64_t> all = idx.entries();
+    SeenTxIndex copy;
+    copy.insert(all.data(), all.size());
+    VERIFIE(copy.size() == 3000 && copy.findDuplicates(a) == 3000);
+
+    // Chaîne stockée : 25 blocs, un snapshot tous les 10
+    Blockchain bc(gen.genesisAllocations());
+    {
+        ChainStorage storage(dir, 10);
+        storage.append(bc, bc.chain[0]);
+        for (int i = 0; i < 25; ++i) {
+            TxColumns txs;
+            gen.fill(txs, 20);
+            BlockTx b = sealed(bc, std::move(txs));
+            VERIFIE(bc.addBlock(b));
+            storage.append(bc, b);
+        }
+    }
+    VERIFIE(!accepts(bc, bc.chain[5].transactions));
+
+    // Après restauration depuis le snapshot 20 : rejeux d'avant et d'après le snapshot refusés
+    Blockchain restored;
+    ChainStorage storage(dir, 10);
+    VERIFIE(storage.restore(restored, true) && restored.chain[0].id == 20);
+    VERIFIE(restored.seen.size() == bc.seen.size());
+    VERIFIE(!accepts(restored, bc.chain[5].transactions));
+    VERIFIE(!accepts(restored, bc.chain[23].transactions));
+    TxColumns mixed;
+    gen.fill(mixed, 5);
+    mixed.push(bc.chain[1].transactions.get(0));
+    VERIFIE(!accepts(restored, mixed));
+    TxColumns fresh;
+    gen.fill(fresh, 5);
+    VERIFIE(accepts(restored, fresh));
+
+    // Restauration complète : même index, reconstruit depuis les blocs
+    Blockchain full;
+    VERIFIE(storage.restore(full, false) && full.seen.size() == bc.seen.size());
+    VERIFIE(!accepts(full, bc.chain[12].transactions));
+
+    // isValid reconstruit l'index pendant le parcours : un rejeu passé malgré un index vidé est détecté
+    VERIFIE(full.isValid());
+    full.seen.clear();
+    VERIFIE(accepts(full, bc.chain[12].transactions));
+    VERIFIE(!full.isValid());
+    Blockchain other(gen.genesisAllocations());
+    ConsensusChain<PoSConsensus> cc(other, PoSConsensus(pos));
+    TxColumns once;
+    gen.fill(once, 6);
+    VERIFIE(cc.produce(once) && cc.isValid());
+    other.seen.clear();
+    VERIFIE(cc.produce(once) && !cc.isValid() && !other.isValid());
+    return verifBilan("transactions rejouées");
+}
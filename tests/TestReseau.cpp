@@ -0,0 +1,31 @@
+// Réseau simulé : seules les transactions de la chaîne principale sont confirmées,
+// et une réorganisation rend au mempool celles des blocs abandonnés
+#include "Verif.h"
+
+int main() {
+    // PoW très facile, latence élevée : les nœuds minent souvent en concurrence et changent de branche
+    NetworkConfig cfg;
+    cfg.nodes = 4;
+    cfg.latencyMs = 30;
+    cfg.lossRate = 0.05;
+    cfg.difficulty = 1;
+    cfg.targetHeight = 20;
+    cfg.txsPerBlock = 20;
+    size_t reorgs = 0;
+    for (uint64_t seed = 1; seed <= 3; ++seed) {
+        cfg.seed = seed;
+        NetworkReport r = NetworkSimulator<PoWConsensus>(cfg, PoWConsensus(cfg.difficulty)).run();
+        VERIFIE(r.height >= cfg.targetHeight);
+        VERIFIE(r.confirmedMatchesChain);
+        reorgs += r.reorgs;
+    }
+    VERIFIE(reorgs > 0);
+
+    // PoS : un proposant par créneau, la vue confirmée suit aussi la chaîne principale
+    PoSSystem validators(networkValidators(cfg));
+    cfg.targetHeight = 5;
+    cfg.slotMs = 20;
+    NetworkReport r = NetworkSimulator<PoSConsensus>(cfg, PoSConsensus(validators)).run();
+    VERIFIE(r.height >= cfg.targetHeight && r.confirmedMatchesChain);
+    return verifBilan("réseau");
+}
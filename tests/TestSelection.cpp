@@ -0,0 +1,30 @@
+// Sélection PoS dérivée du bloc précédent : graine = premier mot de fastSHA256(prevHash:créneau),
+// tirage portable, donc même validateur sur tout nœud et à chaque exécution
+#include "Verif.h"
+
+int main() {
+    string zero(64, '0');
+    VERIFIE(selectionPreimage(zero, 7) == zero + ":7");
+    VERIFIE(selectionSeed(zero, 7) == stoull(fastSHA256(selectionPreimage(zero, 7)).substr(0, 16), nullptr, 16));
+    VERIFIE(selectionSeed(zero, 7) == 15996778339776137437ULL);
+    VERIFIE(selectionSeed(zero, 7) != selectionSeed(zero, 8));
+    VERIFIE(selectionSeed(zero, 7) != selectionSeed(string(64, '1'), 7));
+
+    // Valeurs de référence : stakes par défaut (Alice 50, Bob 30, Charlie 20), créneaux 1 à 8
+    PoSSystem pos, other;
+    vector<string> expected = {"Alice", "Charlie", "Bob", "Alice", "Alice", "Alice", "Charlie", "Alice"};
+    for (uint64_t h = 1; h <= 8; ++h) {
+        VERIFIE(pos.chooseValidator(zero, h) == expected[h - 1]);
+        VERIFIE(other.chooseValidator(zero, h) == pos.chooseValidator(zero, h));
+        VERIFIE(pos.validatorForSeed(selectionSeed(zero, h)) == expected[h - 1]);
+    }
+
+    // Un bloc porte le validateur de son créneau : tout autre nom est refusé
+    Blockchain bc;
+    BlockTx b(1, bc.chain.back().hash, TxColumns());
+    b.validatePoS(pos.chooseValidator(b.prevHash, b.id));
+    VERIFIE(pos.verifyValidator(b));
+    b.validatePoS(b.validator == "Alice" ? "Bob" : "Alice");
+    VERIFIE(!pos.verifyValidator(b));
+    return verifBilan("sélection des validateurs");
+}
@@ -0,0 +1,75 @@
+// Registre de stakes (Fenwick) : mises à jour, intervalles cumulés exacts, fréquences de tirage ;
+// PoSSystem : dépôt, retrait, slashing et sélection reproductible
+#include "Verif.h"
+
+// Fréquence observée de name sur draws tirages, comparée à stake/total à tol près
+static bool frequencyNear(const StakeRegistry& reg, const string& name, size_t draws, double tol) {
+    SplitMix64 r(2024);
+    size_t hits = 0;
+    for (size_t i = 0; i < draws; ++i) hits += reg.sample(r) == name;
+    return fabs((double)hits / draws - (double)reg.stakeOf(name) / reg.total()) < tol;
+}
+
+int main() {
+    StakeRegistry reg;
+    reg.setStake("a", 50);
+    reg.setStake("b", 30);
+    reg.setStake("c", 20);
+    VERIFIE(reg.size() == 3 && reg.total() == 100);
+    // Intervalles cumulés dans l'ordre des emplacements : a [0,50), b [50,80), c [80,100)
+    VERIFIE(reg.sampleAt(0) == "a" && reg.sampleAt(49) == "a");
+    VERIFIE(reg.sampleAt(50) == "b" && reg.sampleAt(79) == "b");
+    VERIFIE(reg.sampleAt(80) == "c" && reg.sampleAt(99) == "c");
+    VERIFIE(frequencyNear(reg, "a", 200000, 0.01) && frequencyNear(reg, "c", 200000, 0.01));
+
+    // Baisse, retrait, réutilisation d'emplacement, croissance au-delà de la capacité initiale
+    reg.setStake("a", 10);
+    VERIFIE(reg.total() == 60 && reg.stakeOf("a") == 10);
+    VERIFIE(reg.remove("b") && !reg.remove("b"));
+    VERIFIE(reg.total() == 30 && reg.size() == 2 && reg.stakeOf("b") == 0);
+    reg.setStake("c", 0);
+    VERIFIE(reg.size() == 1);
+    for (int i = 0; i < 100; ++i) reg.setStake("v" + to_string(i), 1 + i);
+    VERIFIE(reg.size() == 101 && reg.total() == 10 + 5050);
+    VERIFIE(frequencyNear(reg, "v99", 400000, 0.005) && frequencyNear(reg, "a", 400000, 0.005));
+    SplitMix64 r(1);
+    for (int i = 0; i < 10000; ++i) { const string& v = reg.sample(r); VERIFIE(v != "b" && v != "c"); }
+
+    // Table d'alias sur les mêmes poids : mêmes fréquences
+    AliasSampler alias;
+    alias.build({50, 30, 20});
+    SplitMix64 ra(9);
+    size_t hits[3] = {0, 0, 0};
+    for (int i = 0; i < 200000; ++i) ++hits[alias.sample(ra)];
+    VERIFIE(fabs(hits[0] / 200000.0 - 0.5) < 0.01 && fabs(hits[2] / 200000.0 - 0.2) < 0.01);
+
+    // PoSSystem : ensemble dynamique
+    PoSSystem pos, twin;
+    VERIFIE(pos.size() == 3 && pos.totalStake() == 100);
+    pos.deposit("Dora", 100);
+    VERIFIE(pos.stakeOf("Dora") == 100 && pos.size() == 4);
+    VERIFIE(!pos.withdraw("Bob", 31) && pos.stakeOf("Bob") == 30);
+    VERIFIE(pos.withdraw("Bob", 30) && pos.size() == 3);
+    VERIFIE(pos.slash("Alice", 100) == 5 && pos.stakeOf("Alice") == 45);
+    VERIFIE(pos.slash("Charlie", 1000) == 20 && pos.size() == 2);
+    bool doraChosen = false;
+    for (uint64_t h = 0; h < 200; ++h) {
+        string v = pos.chooseValidator(string(64, '0'), h);
+        VERIFIE(v == "Alice" || v == "Dora");
+        doraChosen |= v == "Dora";
+    }
+    VERIFIE(doraChosen);
+
+    // Même suite d'opérations : mêmes validateurs, créneau par créneau
+    twin.deposit("Dora", 100);
+    twin.withdraw("Bob", 30);
+    twin.slash("Alice", 100);
+    twin.slash("Charlie", 1000);
+    for (uint64_t h = 0; h < 200; ++h) VERIFIE(twin.chooseValidator("abc", h) == pos.chooseValidator("abc", h));
+    VERIFIE(twin.validators() == pos.validators());
+
+    // Valeurs de référence de SplitMix64 (graine 1234567) : le tirage ne dépend pas de la bibliothèque standard
+    SplitMix64 ref(1234567);
+    VERIFIE(ref.next() == 6457827717110365317ULL && ref.next() == 3203168211198807973ULL);
+    return verifBilan("registre de stakes");
+}
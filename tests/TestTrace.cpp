@@ -0,0 +1,63 @@
+// Traces chronologiques : JSON trace-event bien formé (noms de threads, intervalles "X" en µs,
+// argument facultatif), intervalles imbriqués cohérents, tampon circulaire qui garde les plus récents
+#include "Verif.h"
+
+static size_t occurrences(const string& s, const string& what) {
+    size_t n = 0;
+    for (size_t p = s.find(what); p != string::npos; p = s.find(what, p + 1)) ++n;
+    return n;
+}
+
+// Valeur numérique qui suit key dans l'objet de l'intervalle nommé name
+static double field(const string& json, const string& name, const string& key) {
+    size_t at = json.find("{\"name\":\"" + name + "\"");
+    size_t p = json.find("\"" + key + "\":", at) + key.size() + 3;
+    return stod(json.substr(p, json.find_first_of(",}", p) - p));
+}
+
+int main() {
+    string dir = verifRepertoire("trace");
+    Tracer& tracer = Tracer::instance();
+    Tracer::nameThread("principal");
+    tracer.start(4);
+    {
+        TraceSpan outer("externe", "bloc", 5);
+        this_thread::sleep_for(milliseconds(2));
+        { TraceSpan inner("interne", "merkle"); this_thread::sleep_for(milliseconds(1)); }
+    }
+    // Thread aidant : 10 intervalles pour 4 places, seuls les 4 derniers restent
+    thread helper([] {
+        Tracer::nameThread("aide");
+        static const char* names[] = {"a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", "a8", "a9"};
+        for (auto n : names) TraceSpan span(n, "test");
+    });
+    helper.join();
+    tracer.stop();
+    { TraceSpan ignored("ignoré"); }
+
+    string path = dir + "/trace.json";
+    size_t events = tracer.writeFile(path);
+    ifstream in(path);
+    string json((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+
+    if (!Tracer::enabled() && events == 0) return verifBilan("traces chronologiques"); // -DATELIER_NO_TRACE
+    VERIFIE(events == 6 && tracer.dropped() == 6);
+    VERIFIE(json.compare(0, 16, "{\"traceEvents\":[") == 0);
+    string tail = "],\"displayTimeUnit\":\"ns\"}\n";
+    VERIFIE(json.size() > tail.size() && json.compare(json.size() - tail.size(), tail.size(), tail) == 0);
+    VERIFIE(occurrences(json, "{") == occurrences(json, "}") && occurrences(json, "[") == occurrences(json, "]"));
+    VERIFIE(occurrences(json, "\"ph\":\"X\"") == events && occurrences(json, "\"ph\":\"M\"") == 2);
+    VERIFIE(json.find("\"args\":{\"name\":\"principal\"}") != string::npos && json.find("\"args\":{\"name\":\"aide\"}") != string::npos);
+    VERIFIE(json.find("\"a5\"") == string::npos && json.find("\"a6\"") != string::npos && json.find("\"a9\"") != string::npos);
+    VERIFIE(json.find("ignoré") == string::npos);
+
+    // Argument présent seulement quand il est fourni ; l'intervalle interne est contenu dans l'externe
+    VERIFIE(field(json, "externe", "n") == 5);
+    size_t inner = json.find("{\"name\":\"interne\"");
+    VERIFIE(json.substr(inner, json.find('}', inner) - inner).find("args") == string::npos);
+    double ts0 = field(json, "externe", "ts"), dur0 = field(json, "externe", "dur");
+    double ts1 = field(json, "interne", "ts"), dur1 = field(json, "interne", "dur");
+    VERIFIE(ts0 >= 0 && dur0 >= 2000 && dur1 >= 1000);
+    VERIFIE(ts1 >= ts0 && ts1 + dur1 <= ts0 + dur0 + 0.001);
+    return verifBilan("traces chronologiques");
+}
@@ -0,0 +1,62 @@
+// Vérification par lots : sur une chaîne PoS saine puis falsifiée (hash, chaînage, validateur),
+// le résultat par lots coïncide avec la vérification bloc par bloc, quel que soit le découpage
+#include "Verif.h"
+
+int main() {
+    const size_t nBlocks = 3000, epoch2 = 1500;
+    WorkloadConfig cfg;
+    cfg.accounts = 200;
+    WorkloadGenerator gen(cfg);
+    StakeHistory history;
+    history.set(1, {{"Alice", 50}, {"Bob", 30}, {"Charlie", 20}});
+    history.set(epoch2, {{"Alice", 10}, {"Bob", 10}, {"Dora", 80}});
+
+    Blockchain bc(gen.genesisAllocations());
+    for (size_t i = 1; i <= nBlocks; ++i) {
+        TxColumns txs;
+        gen.fill(txs, 4);
+        BlockTx b(bc.chain.back().id + 1, bc.chain.back().hash, std::move(txs));
+        b.validatePoS(history.at(b.id)->chooseValidator(b.prevHash, b.id));
+        VERIFIE(bc.addBlock(b));
+    }
+
+    // Chaîne vivante lue par snapshot, sans copie
+    auto view = bc.chain.snapshot();
+    VERIFIE(view.size() == nBlocks + 1);
+    VERIFIE(verifyPoSBatch(view, 0, view.size(), history, 1).ok());
+    VERIFIE(verifyPoSBatch(view, 0, view.size(), history, 4).ok());
+
+    // Copie falsifiée : hash altéré, bloc rattaché à une autre branche, validateur intrus
+    // (chaque hash modifié rompt aussi le chaînage du bloc suivant)
+    vector<BlockTx> blocks(view.begin(), view.end());
+    blocks[100].hash[3] ^= 1;
+    blocks[1700].prevHash = fastSHA256("fork"); blocks[1700].calculateHash();
+    blocks[2500].validator = "intrus"; blocks[2500].calculateHash();
+
+    // Référence : un bloc à la fois, époque recherchée pour chaque hauteur
+    auto reference = [&](size_t first, size_t last) {
+        BatchVerifyResult r;
+        for (size_t i = first; i < last; ++i) {
+            const BlockTx& b = blocks[i];
+            if (fastSHA256(b.headerData()) != b.hash) r.badHash.push_back(i);
+            if (i > 0 && b.prevHash != blocks[i - 1].hash) r.badLink.push_back(i);
+            const PoSSystem* table = history.at(b.id);
+            if (i > 0 && (!table || b.validator != table->chooseValidator(b.prevHash, b.id))) r.badValidator.push_back(i);
+        }
+        return r;
+    };
+    auto same = [](const BatchVerifyResult& a, const BatchVerifyResult& b) {
+        return a.badHash == b.badHash && a.badLink == b.badLink && a.badValidator == b.badValidator;
+    };
+
+    BatchVerifyResult ref = reference(0, blocks.size());
+    VERIFIE(ref.badHash == vector<size_t>{100});
+    VERIFIE((ref.badLink == vector<size_t>{101, 1700, 1701, 2501}));
+    VERIFIE(find(ref.badValidator.begin(), ref.badValidator.end(), 2500) != ref.badValidator.end());
+    for (unsigned threads : {1u, 2u, 4u, 7u}) VERIFIE(same(verifyPoSBatch(blocks, 0, blocks.size(), history, threads), ref));
+    // Plages partielles, dont une à cheval sur le changement d'époque
+    VERIFIE(same(verifyPoSBatch(blocks, 90, 110, history, 1), reference(90, 110)));
+    VERIFIE(same(verifyPoSBatch(blocks, 1000, 2600, history, 3), reference(1000, 2600)));
+    VERIFIE(verifyPoSBatch(blocks, 200, 1600, history, 2).ok());
+    return verifBilan("vérification par lots");
+}
@@ -0,0 +1,28 @@
+// Vérifications des tests (make check) : indépendantes de NDEBUG, contrairement à assert.
+// Chaque test est un exécutable ; un échec est signalé avec sa ligne et le code de sortie vaut 1.
+#ifndef VERIF_H
+#define VERIF_H
+
+#include "BlockchainCore.h"
+
+inline int& verifEchecs() { static int n = 0; return n; }
+
+#define VERIFIE(cond) do { if (!(cond)) { ++verifEchecs(); cerr << __FILE__ << ":" << __LINE__ << " : échec de " #cond "\n"; } } while (0)
+
+// Fin du test : bilan sur une ligne, code de sortie pour make check
+inline int verifBilan(const char* nom) {
+    cout << (verifEchecs() ? "ÉCHEC " : "ok     ") << nom;
+    if (verifEchecs()) cout << " (" << verifEchecs() << " vérification(s) en échec)";
+    cout << "\n";
+    return verifEchecs() ? 1 : 0;
+}
+
+// Répertoire temporaire vide, propre à un test
+inline string verifRepertoire(const string& nom) {
+    string dir = (filesystem::temp_directory_path() / ("atelier_test_" + nom)).string();
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+    return dir;
+}
+
+#endif